@@ -0,0 +1,634 @@
+#ifndef SJTU_ALGORITHM_HPP
+#define SJTU_ALGORITHM_HPP
+
+#include "deque.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sjtu {
+/**
+ * algorithms over the elements of a deque, a segment at a time
+ * a segment is a run of elements contiguous in memory, it is handled by
+ * a plain pointer loop, and the deque is only asked for the next one
+ * at its end, so no element pays for a block boundary check
+ */
+
+/**
+ * call f(first, last) on the segments of the elements from index first
+ * to last (not included), in order, and return f
+ * throw index_out_of_bound if last > d.size().
+ */
+template <class T, class Policy, class Alloc, class F>
+F for_each_segment(deque<T, Policy, Alloc>& d, size_t first, size_t last, F f)
+{
+    if (last > d.size())
+        throw index_out_of_bound();
+    while (first < last) {
+        std::pair<T*, T*> seg = d.segment(first);
+        if ((size_t)(seg.second - seg.first) > last - first)
+            seg.second = seg.first + (last - first);
+        f(seg.first, seg.second);
+        first += seg.second - seg.first;
+    }
+    return f;
+}
+template <class T, class Policy, class Alloc, class F>
+F for_each_segment(const deque<T, Policy, Alloc>& d, size_t first, size_t last, F f)
+{
+    if (last > d.size())
+        throw index_out_of_bound();
+    while (first < last) {
+        std::pair<const T*, const T*> seg = d.segment(first);
+        if ((size_t)(seg.second - seg.first) > last - first)
+            seg.second = seg.first + (last - first);
+        f(seg.first, seg.second);
+        first += seg.second - seg.first;
+    }
+    return f;
+}
+template <class T, class Policy, class Alloc, class F>
+F for_each_segment(deque<T, Policy, Alloc>& d, F f)
+{
+    return for_each_segment(d, 0, d.size(), f);
+}
+template <class T, class Policy, class Alloc, class F>
+F for_each_segment(const deque<T, Policy, Alloc>& d, F f)
+{
+    return for_each_segment(d, 0, d.size(), f);
+}
+
+/**
+ * call f on every element in order, and return f
+ */
+template <class T, class Policy, class Alloc, class F>
+F for_each(deque<T, Policy, Alloc>& d, F f)
+{
+    for_each_segment(d, [&f](T* first, T* last) {
+        for (; first != last; ++first)
+            f(*first);
+    });
+    return f;
+}
+template <class T, class Policy, class Alloc, class F>
+F for_each(const deque<T, Policy, Alloc>& d, F f)
+{
+    for_each_segment(d, [&f](const T* first, const T* last) {
+        for (; first != last; ++first)
+            f(*first);
+    });
+    return f;
+}
+
+/**
+ * the index of the first element satisfying pred, or d.size()
+ */
+template <class T, class Policy, class Alloc, class Pred>
+size_t find_index(const deque<T, Policy, Alloc>& d, Pred pred)
+{
+    for (size_t i = 0; i < d.size();) {
+        std::pair<const T*, const T*> seg = d.segment(i);
+        for (const T* p = seg.first; p != seg.second; ++p) {
+            if (pred(*p))
+                return i + (p - seg.first);
+        }
+        i += seg.second - seg.first;
+    }
+    return d.size();
+}
+/**
+ * whether comparing the elements of type T with a value of type U can
+ * go through simd_kernels<T>: T has kernels, and U converts to T
+ * exactly, so that comparing the converted value gives the same answer
+ */
+template <class T, class U>
+struct simd_value : std::integral_constant<bool, simd_kernels<T>::enabled && (std::is_same<T, U>::value || (std::is_integral<U>::value && std::is_signed<U>::value && (sizeof(U) < sizeof(T) || (std::is_integral<T>::value && sizeof(U) == sizeof(T)))))> {
+};
+/**
+ * the index of the first element equal to value, or d.size()
+ */
+template <class T, class Policy, class Alloc, class U>
+size_t find_value(const deque<T, Policy, Alloc>& d, const U& value, std::true_type)
+{
+    for (size_t i = 0; i < d.size();) {
+        std::pair<const T*, const T*> seg = d.segment(i);
+        const T* p = simd_kernels<T>::find(seg.first, seg.second, (T)value);
+        if (p != seg.second)
+            return i + (p - seg.first);
+        i += seg.second - seg.first;
+    }
+    return d.size();
+}
+template <class T, class Policy, class Alloc, class U>
+size_t find_value(const deque<T, Policy, Alloc>& d, const U& value, std::false_type)
+{
+    return find_index(d, [&value](const T& x) { return x == value; });
+}
+/**
+ * the first element equal to value or satisfying pred, or end()
+ * on int, long long and double, find uses the vectorized kernels
+ */
+template <class T, class Policy, class Alloc, class Pred>
+typename deque<T, Policy, Alloc>::iterator find_if(deque<T, Policy, Alloc>& d, Pred pred)
+{
+    const deque<T, Policy, Alloc>& c = d;
+    return d.begin() + find_index(c, pred);
+}
+template <class T, class Policy, class Alloc, class Pred>
+typename deque<T, Policy, Alloc>::const_iterator find_if(const deque<T, Policy, Alloc>& d, Pred pred)
+{
+    return d.cbegin() + find_index(d, pred);
+}
+template <class T, class Policy, class Alloc, class U>
+typename deque<T, Policy, Alloc>::iterator find(deque<T, Policy, Alloc>& d, const U& value)
+{
+    const deque<T, Policy, Alloc>& c = d;
+    return d.begin() + find_value(c, value, simd_value<T, U>());
+}
+template <class T, class Policy, class Alloc, class U>
+typename deque<T, Policy, Alloc>::const_iterator find(const deque<T, Policy, Alloc>& d, const U& value)
+{
+    return d.cbegin() + find_value(d, value, simd_value<T, U>());
+}
+
+/**
+ * the number of elements equal to value or satisfying pred
+ * on int, long long and double, count uses the vectorized kernels
+ */
+template <class T, class Policy, class Alloc, class Pred>
+size_t count_if(const deque<T, Policy, Alloc>& d, Pred pred)
+{
+    size_t res = 0;
+    for_each_segment(d, [&](const T* first, const T* last) {
+        for (; first != last; ++first) {
+            if (pred(*first))
+                res++;
+        }
+    });
+    return res;
+}
+template <class T, class Policy, class Alloc, class U>
+size_t count_value(const deque<T, Policy, Alloc>& d, const U& value, std::true_type)
+{
+    size_t res = 0;
+    for_each_segment(d, [&](const T* first, const T* last) {
+        res += simd_kernels<T>::count(first, last, (T)value);
+    });
+    return res;
+}
+template <class T, class Policy, class Alloc, class U>
+size_t count_value(const deque<T, Policy, Alloc>& d, const U& value, std::false_type)
+{
+    return count_if(d, [&value](const T& x) { return x == value; });
+}
+template <class T, class Policy, class Alloc, class U>
+size_t count(const deque<T, Policy, Alloc>& d, const U& value)
+{
+    return count_value(d, value, simd_value<T, U>());
+}
+
+/**
+ * fold the elements in order into init, with op or operator+
+ * the sum of int or long long elements into an init of the same type
+ * is vectorized. a sum of doubles is not, as adding them in another
+ * order would round differently.
+ */
+template <class T, class Policy, class Alloc, class U, class Op>
+U accumulate(const deque<T, Policy, Alloc>& d, U init, Op op)
+{
+    for_each_segment(d, [&](const T* first, const T* last) {
+        for (; first != last; ++first)
+            init = op(std::move(init), *first);
+    });
+    return init;
+}
+template <class T, class Policy, class Alloc, class U>
+U accumulate_value(const deque<T, Policy, Alloc>& d, U init, std::true_type)
+{
+    for_each_segment(d, [&](const T* first, const T* last) {
+        init = simd_kernels<T>::sum(first, last, init);
+    });
+    return init;
+}
+template <class T, class Policy, class Alloc, class U>
+U accumulate_value(const deque<T, Policy, Alloc>& d, U init, std::false_type)
+{
+    for_each_segment(d, [&](const T* first, const T* last) {
+        for (; first != last; ++first)
+            init = std::move(init) + *first;
+    });
+    return init;
+}
+template <class T, class Policy, class Alloc, class U>
+U accumulate(const deque<T, Policy, Alloc>& d, U init)
+{
+    return accumulate_value(d, init, std::integral_constant<bool, simd_kernels<T>::enabled && std::is_integral<T>::value && std::is_same<T, U>::value>());
+}
+
+/**
+ * the index of the first smallest (largest) element by comp, or
+ * d.size() if d is empty
+ */
+template <class T, class Policy, class Alloc, class Comp>
+size_t extreme_index(const deque<T, Policy, Alloc>& d, Comp comp, bool largest, std::false_type)
+{
+    size_t res = d.size();
+    const T* best = nullptr;
+    for (size_t i = 0; i < d.size();) {
+        std::pair<const T*, const T*> seg = d.segment(i);
+        for (const T* p = seg.first; p != seg.second; ++p) {
+            if (best == nullptr || (largest ? comp(*best, *p) : comp(*p, *best))) {
+                best = p;
+                res = i + (p - seg.first);
+            }
+        }
+        i += seg.second - seg.first;
+    }
+    return res;
+}
+/**
+ * the same with operator<, a kernel call per segment
+ * a segment holding a NaN falls back to the loop above, so that the
+ * answer stays the one of std::min_element
+ */
+template <class T, class Policy, class Alloc>
+size_t extreme_index(const deque<T, Policy, Alloc>& d, std::less<T> comp, bool largest, std::true_type)
+{
+    size_t res = d.size();
+    const T* best = nullptr;
+    for (size_t i = 0; i < d.size();) {
+        std::pair<const T*, const T*> seg = d.segment(i);
+        const T* p = largest ? simd_kernels<T>::max_element(seg.first, seg.second) : simd_kernels<T>::min_element(seg.first, seg.second);
+        if (p == seg.second)
+            return extreme_index(d, comp, largest, std::false_type());
+        if (best == nullptr || (largest ? *best < *p : *p < *best)) {
+            best = p;
+            res = i + (p - seg.first);
+        }
+        i += seg.second - seg.first;
+    }
+    return res;
+}
+/**
+ * the first smallest element by comp or operator<, or end() if d is
+ * empty
+ * on int, long long and double with operator<, min_element uses the
+ * vectorized kernels
+ */
+template <class T, class Policy, class Alloc, class Comp>
+typename deque<T, Policy, Alloc>::iterator min_element(deque<T, Policy, Alloc>& d, Comp comp)
+{
+    const deque<T, Policy, Alloc>& c = d;
+    return d.begin() + extreme_index(c, comp, false, std::false_type());
+}
+template <class T, class Policy, class Alloc, class Comp>
+typename deque<T, Policy, Alloc>::const_iterator min_element(const deque<T, Policy, Alloc>& d, Comp comp)
+{
+    return d.cbegin() + extreme_index(d, comp, false, std::false_type());
+}
+template <class T, class Policy, class Alloc>
+typename deque<T, Policy, Alloc>::iterator min_element(deque<T, Policy, Alloc>& d)
+{
+    const deque<T, Policy, Alloc>& c = d;
+    return d.begin() + extreme_index(c, std::less<T>(), false, std::integral_constant<bool, simd_kernels<T>::enabled>());
+}
+template <class T, class Policy, class Alloc>
+typename deque<T, Policy, Alloc>::const_iterator min_element(const deque<T, Policy, Alloc>& d)
+{
+    return d.cbegin() + extreme_index(d, std::less<T>(), false, std::integral_constant<bool, simd_kernels<T>::enabled>());
+}
+/**
+ * the first largest element by comp or operator<, or end() if d is
+ * empty
+ */
+template <class T, class Policy, class Alloc, class Comp>
+typename deque<T, Policy, Alloc>::iterator max_element(deque<T, Policy, Alloc>& d, Comp comp)
+{
+    const deque<T, Policy, Alloc>& c = d;
+    return d.begin() + extreme_index(c, comp, true, std::false_type());
+}
+template <class T, class Policy, class Alloc, class Comp>
+typename deque<T, Policy, Alloc>::const_iterator max_element(const deque<T, Policy, Alloc>& d, Comp comp)
+{
+    return d.cbegin() + extreme_index(d, comp, true, std::false_type());
+}
+template <class T, class Policy, class Alloc>
+typename deque<T, Policy, Alloc>::iterator max_element(deque<T, Policy, Alloc>& d)
+{
+    const deque<T, Policy, Alloc>& c = d;
+    return d.begin() + extreme_index(c, std::less<T>(), true, std::integral_constant<bool, simd_kernels<T>::enabled>());
+}
+template <class T, class Policy, class Alloc>
+typename deque<T, Policy, Alloc>::const_iterator max_element(const deque<T, Policy, Alloc>& d)
+{
+    return d.cbegin() + extreme_index(d, std::less<T>(), true, std::integral_constant<bool, simd_kernels<T>::enabled>());
+}
+
+/**
+ * copy the elements in order to out, and return the end of the output
+ * each segment is copied by std::copy, which moves trivial types
+ * with memmove when out is a pointer
+ */
+template <class T, class Policy, class Alloc, class OutputIt>
+OutputIt copy(const deque<T, Policy, Alloc>& d, OutputIt out)
+{
+    for_each_segment(d, [&out](const T* first, const T* last) {
+        out = std::copy(first, last, out);
+    });
+    return out;
+}
+
+/**
+ * the parallel algorithms cut the deque into chunks of consecutive
+ * elements, each one handled by a segment loop on a thread of pool
+ * a chunk has at least parallel_grain elements, and there are a few
+ * chunks per thread, so that a slow thread holds the others back less.
+ * the functions passed are called from several threads at once.
+ */
+enum : size_t {
+    parallel_grain = 1 << 14
+};
+inline size_t parallel_chunks(size_t n, const thread_pool& pool)
+{
+    return std::min((n + parallel_grain - 1) / parallel_grain, pool.size() * 4);
+}
+
+/**
+ * call f on every element
+ */
+template <class T, class Policy, class Alloc, class F>
+void parallel_for_each(deque<T, Policy, Alloc>& d, F f, thread_pool& pool = thread_pool::instance())
+{
+    d.detach();
+    size_t n = d.size(), chunks = parallel_chunks(n, pool);
+    pool.run(chunks, [&](size_t k) {
+        for_each_segment(d, n * k / chunks, n * (k + 1) / chunks, [&f](T* first, T* last) {
+            for (; first != last; ++first)
+                f(*first);
+        });
+    });
+    return;
+}
+
+/**
+ * store f(x) for every element x of in at the same index of out
+ * out is resized to the size of in with default constructed elements,
+ * it may be in itself.
+ */
+template <class T, class P1, class A1, class U, class P2, class A2, class F>
+void parallel_transform(const deque<T, P1, A1>& in, deque<U, P2, A2>& out, F f, thread_pool& pool = thread_pool::instance())
+{
+    while (out.size() < in.size())
+        out.emplace_back();
+    while (out.size() > in.size())
+        out.pop_back();
+    out.detach();
+    size_t n = in.size(), chunks = parallel_chunks(n, pool);
+    pool.run(chunks, [&](size_t k) {
+        size_t i = n * k / chunks, last = n * (k + 1) / chunks;
+        while (i < last) {
+            std::pair<const T*, const T*> src = in.segment(i);
+            std::pair<U*, U*> dst = out.segment(i);
+            size_t len = std::min(std::min<size_t>(src.second - src.first, dst.second - dst.first), last - i);
+            for (size_t j = 0; j < len; j++)
+                dst.first[j] = f(src.first[j]);
+            i += len;
+        }
+    });
+    return;
+}
+
+/**
+ * fold the elements into init with op, which should be associative
+ * op is called as op(U, T) inside a chunk, whose partial result starts
+ * as U(its first element), and as op(U, U) to combine the chunks from
+ * left to right after they have all finished, so op needn't commute.
+ * deterministic cuts the chunks at fixed indices, so the result doesn't
+ * depend on the number of threads either, even for floating point.
+ * otherwise there is one chunk per few threads.
+ */
+template <class T, class Policy, class Alloc, class U, class Op>
+U parallel_reduce(const deque<T, Policy, Alloc>& d, U init, Op op, bool deterministic = true, thread_pool& pool = thread_pool::instance())
+{
+    size_t n = d.size();
+    if (n == 0)
+        return init;
+    size_t chunks = deterministic ? (n + parallel_grain - 1) / parallel_grain : parallel_chunks(n, pool);
+    std::vector<std::unique_ptr<U>> part(chunks);
+    pool.run(chunks, [&](size_t k) {
+        size_t first = deterministic ? k * parallel_grain : n * k / chunks;
+        size_t last = deterministic ? std::min(n, first + parallel_grain) : n * (k + 1) / chunks;
+        std::unique_ptr<U> res(new U(*d.try_at(first)));
+        for_each_segment(d, first + 1, last, [&](const T* from, const T* to) {
+            for (; from != to; ++from)
+                *res = op(std::move(*res), *from);
+        });
+        part[k] = std::move(res);
+    });
+    for (size_t k = 0; k < part.size(); k++)
+        init = op(std::move(init), std::move(*part[k]));
+    return init;
+}
+
+/**
+ * the number of elements satisfying pred
+ */
+template <class T, class Policy, class Alloc, class Pred>
+size_t parallel_count_if(const deque<T, Policy, Alloc>& d, Pred pred, thread_pool& pool = thread_pool::instance())
+{
+    size_t n = d.size(), chunks = parallel_chunks(n, pool);
+    std::atomic<size_t> res(0);
+    pool.run(chunks, [&](size_t k) {
+        size_t cnt = 0;
+        for_each_segment(d, n * k / chunks, n * (k + 1) / chunks, [&](const T* first, const T* last) {
+            for (; first != last; ++first) {
+                if (pred(*first))
+                    cnt++;
+            }
+        });
+        res += cnt;
+    });
+    return res;
+}
+
+/**
+ * the index of the first element satisfying pred, or d.size()
+ * a chunk stops at the end of a segment once an earlier match is known
+ */
+template <class T, class Policy, class Alloc, class Pred>
+size_t parallel_find_index(const deque<T, Policy, Alloc>& d, Pred pred, thread_pool& pool = thread_pool::instance())
+{
+    size_t n = d.size(), chunks = parallel_chunks(n, pool);
+    std::atomic<size_t> res(n);
+    pool.run(chunks, [&](size_t k) {
+        size_t i = n * k / chunks, last = n * (k + 1) / chunks;
+        while (i < last && i < res.load(std::memory_order_relaxed)) {
+            std::pair<const T*, const T*> seg = d.segment(i);
+            size_t len = std::min<size_t>(seg.second - seg.first, last - i);
+            for (size_t j = 0; j < len; j++) {
+                if (pred(seg.first[j])) {
+                    size_t found = i + j, cur = res.load();
+                    while (found < cur && !res.compare_exchange_weak(cur, found))
+                        ;
+                    return;
+                }
+            }
+            i += len;
+        }
+    });
+    return res;
+}
+template <class T, class Policy, class Alloc, class Pred>
+typename deque<T, Policy, Alloc>::iterator parallel_find_if(deque<T, Policy, Alloc>& d, Pred pred, thread_pool& pool = thread_pool::instance())
+{
+    const deque<T, Policy, Alloc>& c = d;
+    return d.begin() + parallel_find_index(c, pred, pool);
+}
+template <class T, class Policy, class Alloc, class Pred>
+typename deque<T, Policy, Alloc>::const_iterator parallel_find_if(const deque<T, Policy, Alloc>& d, Pred pred, thread_pool& pool = thread_pool::instance())
+{
+    return d.cbegin() + parallel_find_index(d, pred, pool);
+}
+
+/**
+ * the number of elements taken from a in the first k elements of the
+ * stable merge of the sorted ranges a (length p) and b (length q)
+ */
+template <class T, class Comp>
+size_t merge_rank(const T* a, size_t p, const T* b, size_t q, size_t k, Comp& comp)
+{
+    size_t lo = k > q ? k - q : 0, hi = std::min(k, p);
+    while (lo < hi) {
+        size_t i = (lo + hi) / 2, j = k - i;
+        if (j == 0 || comp(b[j - 1], a[i]))
+            hi = i;
+        else
+            lo = i + 1;
+    }
+    return lo;
+}
+/**
+ * sort the elements with comp, keeping the order of equal elements if
+ * stable is set
+ * the elements are moved into a buffer, whose chunks are sorted in
+ * parallel. if there are several chunks, they are moved on into a second
+ * buffer and merged pairwise round by round between the two, the
+ * moved-from elements of the first one are assigned by the merges.
+ * every merge is cut into pieces by merge_rank, so the last rounds
+ * still keep all the threads busy. the cuts are all found before any
+ * piece is merged, as merging moves the elements they look at.
+ * the sorted elements are moved back into the same slots, so the
+ * blocks are left as they are.
+ */
+template <class T, class Policy, class Alloc, class Comp>
+void merge_sort(deque<T, Policy, Alloc>& d, Comp comp, bool stable, thread_pool& pool)
+{
+    size_t n = d.size();
+    if (n < 2)
+        return;
+    d.detach();
+    std::vector<T> a;
+    a.reserve(n);
+    for_each_segment(d, [&a](T* first, T* last) {
+        for (; first != last; ++first)
+            a.emplace_back(std::move(*first));
+    });
+    size_t chunks = parallel_chunks(n, pool);
+    std::vector<size_t> bound(chunks + 1);
+    for (size_t k = 0; k <= chunks; k++)
+        bound[k] = n * k / chunks;
+    T *src = a.data(), *dst = nullptr;
+    pool.run(chunks, [&](size_t k) {
+        if (stable)
+            std::stable_sort(src + bound[k], src + bound[k + 1], comp);
+        else
+            std::sort(src + bound[k], src + bound[k + 1], comp);
+    });
+    std::vector<T> b;
+    if (bound.size() > 2) {
+        b.reserve(n);
+        for (size_t i = 0; i < n; i++)
+            b.emplace_back(std::move(a[i]));
+        src = b.data();
+        dst = a.data();
+    }
+    size_t piece = std::max<size_t>(parallel_grain, n / (pool.size() * 4));
+    while (bound.size() > 2) {
+        std::vector<size_t> next;
+        std::vector<std::pair<size_t, size_t>> tasks;
+        for (size_t r = 0; r + 1 < bound.size(); r += 2) {
+            size_t lo = bound[r], hi = bound[std::min(r + 2, bound.size() - 1)];
+            next.push_back(lo);
+            for (size_t k = lo; k < hi; k += piece)
+                tasks.push_back(std::make_pair(r, k));
+        }
+        next.push_back(n);
+        std::vector<size_t> rank(tasks.size());
+        pool.run(tasks.size(), [&](size_t t) {
+            size_t r = tasks[t].first;
+            size_t lo = bound[r], mid = bound[r + 1], hi = bound[std::min(r + 2, bound.size() - 1)];
+            rank[t] = merge_rank(src + lo, mid - lo, src + mid, hi - mid, tasks[t].second - lo, comp);
+        });
+        pool.run(tasks.size(), [&](size_t t) {
+            size_t r = tasks[t].first;
+            size_t lo = bound[r], mid = bound[r + 1], hi = bound[std::min(r + 2, bound.size() - 1)];
+            bool last = t + 1 == tasks.size() || tasks[t + 1].first != r;
+            size_t k0 = tasks[t].second - lo, k1 = last ? hi - lo : tasks[t + 1].second - lo;
+            size_t i0 = rank[t], i1 = last ? mid - lo : rank[t + 1];
+            std::merge(std::make_move_iterator(src + lo + i0), std::make_move_iterator(src + lo + i1),
+                std::make_move_iterator(src + mid + k0 - i0), std::make_move_iterator(src + mid + k1 - i1),
+                dst + lo + k0, comp);
+        });
+        bound.swap(next);
+        std::swap(src, dst);
+    }
+    pool.run(chunks, [&](size_t k) {
+        T* from = src + n * k / chunks;
+        for_each_segment(d, n * k / chunks, n * (k + 1) / chunks, [&from](T* first, T* last) {
+            for (; first != last; ++first)
+                *first = std::move(*from++);
+        });
+    });
+    return;
+}
+/**
+ * sort the elements of d in parallel, with comp or operator<
+ */
+template <class T, class Policy, class Alloc, class Comp>
+void sort(deque<T, Policy, Alloc>& d, Comp comp, thread_pool& pool = thread_pool::instance())
+{
+    merge_sort(d, comp, false, pool);
+    return;
+}
+template <class T, class Policy, class Alloc>
+void sort(deque<T, Policy, Alloc>& d)
+{
+    merge_sort(d, std::less<T>(), false, thread_pool::instance());
+    return;
+}
+/**
+ * sort the elements of d in parallel, keeping the order of equal ones
+ */
+template <class T, class Policy, class Alloc, class Comp>
+void stable_sort(deque<T, Policy, Alloc>& d, Comp comp, thread_pool& pool = thread_pool::instance())
+{
+    merge_sort(d, comp, true, pool);
+    return;
+}
+template <class T, class Policy, class Alloc>
+void stable_sort(deque<T, Policy, Alloc>& d)
+{
+    merge_sort(d, std::less<T>(), true, thread_pool::instance());
+    return;
+}
+}
+
+#endif
@@ -0,0 +1,512 @@
+#ifndef SJTU_CONCURRENT_DEQUE_HPP
+#define SJTU_CONCURRENT_DEQUE_HPP
+
+#include "deque.hpp"
+#include "exceptions.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace sjtu {
+/**
+ * a deque shared by several producer and consumer threads
+ * the elements are kept in a list of fixed blocks, and each end has its
+ * own lock over its block and position, so the threads working at the
+ * back never wait for the ones at the front while the deque holds at
+ * least two elements.
+ * a pop first takes an element off an atomic count, which is only done
+ * without the other end's lock while the count is at least 2, so the
+ * two ends can't both take the last element. below that, and for the
+ * operations in the middle, both locks are taken (front first).
+ * a block is freed by the end that leaves it empty, the other end
+ * never touches a block holding no element it may take.
+ */
+template <class T, class Alloc = std::allocator<T>>
+class concurrent_deque {
+private:
+    static constexpr size_t block_capacity = sizeof(T) >= 256 ? 16 : 4096 / sizeof(T);
+    static constexpr size_t cache_line = 64;
+
+    struct Block {
+        Block *prev, *next;
+        alignas(T) unsigned char data[block_capacity * sizeof(T)];
+        Block(Block* prev, Block* next)
+            : prev(prev)
+            , next(next)
+        {
+        }
+        T* at(size_t i)
+        {
+            return reinterpret_cast<T*>(data) + i;
+        }
+    };
+    /**
+     * an end and its lock, padded to a cache line of its own
+     * the first element is at head.blk[head.idx], or at the start of the
+     * next block when head.idx == block_capacity. the last element is at
+     * tail.blk[tail.idx - 1], or at the end of the previous block when
+     * tail.idx == 0. the block of head has no prev, the one of tail has
+     * no next.
+     */
+    struct End {
+        std::mutex lock;
+        Block* blk;
+        size_t idx;
+        char pad[cache_line];
+    };
+    /**
+     * a position between the two ends, moved one element at a time
+     */
+    struct Cursor {
+        Block* blk;
+        size_t idx;
+        T& operator*() const
+        {
+            return *blk->at(idx);
+        }
+        void next()
+        {
+            if (++idx == block_capacity) {
+                blk = blk->next;
+                idx = 0;
+            }
+            return;
+        }
+        void prev()
+        {
+            if (idx == 0) {
+                blk = blk->prev;
+                idx = block_capacity;
+            }
+            idx--;
+            return;
+        }
+    };
+
+    Alloc alloc;
+    End head, tail;
+    /**
+     * the elements constructed and not taken by a pop, and the threads
+     * waiting for one
+     */
+    std::atomic<size_t> count;
+    char pad[cache_line];
+    std::atomic<size_t> waiters;
+    std::mutex wait_lock;
+    std::condition_variable ready;
+
+    /**
+     * take an element off the count if it holds at least least of them
+     */
+    bool reserve(size_t least)
+    {
+        size_t cur = count.load();
+        while (cur >= least) {
+            if (count.compare_exchange_weak(cur, cur - 1))
+                return true;
+        }
+        return false;
+    }
+    /**
+     * count a new element, and wake the waiting threads if there are any
+     */
+    void publish()
+    {
+        count.fetch_add(1);
+        if (waiters.load() != 0) {
+            std::lock_guard<std::mutex> guard(wait_lock);
+            ready.notify_all();
+        }
+        return;
+    }
+    /**
+     * wait until the deque seems not empty, or until deadline if there
+     * is one. return false on timeout
+     */
+    bool wait_element(const std::chrono::steady_clock::time_point* deadline)
+    {
+        std::unique_lock<std::mutex> guard(wait_lock);
+        waiters++;
+        auto seen = [this] { return count.load() != 0; };
+        bool res = true;
+        if (deadline == nullptr)
+            ready.wait(guard, seen);
+        else
+            res = ready.wait_until(guard, *deadline, seen);
+        waiters--;
+        return res;
+    }
+
+    /**
+     * construct an element at an end, holding its lock
+     */
+    template <class... Args>
+    void place_back(Args&&... args)
+    {
+        if (tail.idx == block_capacity) {
+            Block* b = allocator_new<Block>(alloc, tail.blk, nullptr);
+            tail.blk->next = b;
+            tail.blk = b;
+            tail.idx = 0;
+        }
+        ::new ((void*)tail.blk->at(tail.idx)) T(std::forward<Args>(args)...);
+        tail.idx++;
+        publish();
+        return;
+    }
+    template <class... Args>
+    void place_front(Args&&... args)
+    {
+        if (head.idx == 0) {
+            Block* b = allocator_new<Block>(alloc, nullptr, head.blk);
+            head.blk->prev = b;
+            head.blk = b;
+            head.idx = block_capacity;
+        }
+        ::new ((void*)head.blk->at(head.idx - 1)) T(std::forward<Args>(args)...);
+        head.idx--;
+        publish();
+        return;
+    }
+    /**
+     * the first (last) element, after freeing the block of the end if
+     * it is used up, holding the lock of the end with an element reserved
+     */
+    T* first()
+    {
+        if (head.idx == block_capacity) {
+            Block* b = head.blk->next;
+            b->prev = nullptr;
+            allocator_delete(alloc, head.blk);
+            head.blk = b;
+            head.idx = 0;
+        }
+        return head.blk->at(head.idx);
+    }
+    T* last()
+    {
+        if (tail.idx == 0) {
+            Block* b = tail.blk->prev;
+            b->next = nullptr;
+            allocator_delete(alloc, tail.blk);
+            tail.blk = b;
+            tail.idx = block_capacity;
+        }
+        return tail.blk->at(tail.idx - 1);
+    }
+    /**
+     * move the reserved element at an end to out and remove it
+     * if the assignment throws, the element stays and is counted again
+     */
+    void take_front(T& out)
+    {
+        T* p = first();
+        try {
+            out = std::move(*p);
+        } catch (...) {
+            publish();
+            throw;
+        }
+        p->~T();
+        head.idx++;
+        return;
+    }
+    void take_back(T& out)
+    {
+        T* p = last();
+        try {
+            out = std::move(*p);
+        } catch (...) {
+            publish();
+            throw;
+        }
+        p->~T();
+        tail.idx--;
+        return;
+    }
+    /**
+     * the index-th element, holding both locks
+     */
+    Cursor cursor(size_t index)
+    {
+        Cursor res = { head.blk, head.idx + index };
+        while (res.idx >= block_capacity) {
+            res.blk = res.blk->next;
+            res.idx -= block_capacity;
+        }
+        return res;
+    }
+
+public:
+    /**
+     * constructors and destructor
+     * not copyable, the deque is meant to stay in one place while the
+     * threads share it
+     */
+    explicit concurrent_deque(const Alloc& alloc = Alloc())
+        : alloc(alloc)
+        , count(0)
+        , waiters(0)
+    {
+        Block* b = allocator_new<Block>(this->alloc, nullptr, nullptr);
+        head.blk = tail.blk = b;
+        head.idx = tail.idx = block_capacity / 2;
+    }
+    concurrent_deque(const concurrent_deque&) = delete;
+    concurrent_deque& operator=(const concurrent_deque&) = delete;
+    ~concurrent_deque()
+    {
+        for (size_t n = count.load(); n > 0; n--) {
+            first()->~T();
+            head.idx++;
+        }
+        for (Block* b = head.blk; b != nullptr;) {
+            Block* next = b->next;
+            allocator_delete(alloc, b);
+            b = next;
+        }
+    }
+
+    /**
+     * the number of elements, a snapshot that other threads may change
+     * right away
+     */
+    size_t size() const
+    {
+        return count.load();
+    }
+    bool empty() const
+    {
+        return count.load() == 0;
+    }
+
+    /**
+     * add an element to the end / the beginning, waking a waiting pop
+     */
+    template <class... Args>
+    void emplace_back(Args&&... args)
+    {
+        std::lock_guard<std::mutex> guard(tail.lock);
+        place_back(std::forward<Args>(args)...);
+        return;
+    }
+    template <class... Args>
+    void emplace_front(Args&&... args)
+    {
+        std::lock_guard<std::mutex> guard(head.lock);
+        place_front(std::forward<Args>(args)...);
+        return;
+    }
+    void push_back(const T& value)
+    {
+        emplace_back(value);
+        return;
+    }
+    void push_back(T&& value)
+    {
+        emplace_back(std::move(value));
+        return;
+    }
+    void push_front(const T& value)
+    {
+        emplace_front(value);
+        return;
+    }
+    void push_front(T&& value)
+    {
+        emplace_front(std::move(value));
+        return;
+    }
+
+    /**
+     * move the first / last element to out and remove it
+     * return false at once when the deque is empty.
+     */
+    bool try_pop_front(T& out)
+    {
+        if (count.load() == 0)
+            return false;
+        std::lock_guard<std::mutex> front_guard(head.lock);
+        if (reserve(2)) {
+            take_front(out);
+            return true;
+        }
+        std::lock_guard<std::mutex> back_guard(tail.lock);
+        if (!reserve(1))
+            return false;
+        take_front(out);
+        return true;
+    }
+    bool try_pop_back(T& out)
+    {
+        if (count.load() == 0)
+            return false;
+        {
+            std::lock_guard<std::mutex> back_guard(tail.lock);
+            if (reserve(2)) {
+                take_back(out);
+                return true;
+            }
+        }
+        std::lock_guard<std::mutex> front_guard(head.lock);
+        std::lock_guard<std::mutex> back_guard(tail.lock);
+        if (!reserve(1))
+            return false;
+        take_back(out);
+        return true;
+    }
+    /**
+     * the same, waiting for an element while the deque is empty
+     */
+    void wait_pop_front(T& out)
+    {
+        while (!try_pop_front(out))
+            wait_element(nullptr);
+        return;
+    }
+    void wait_pop_back(T& out)
+    {
+        while (!try_pop_back(out))
+            wait_element(nullptr);
+        return;
+    }
+    /**
+     * the same, waiting at most timeout. return false on timeout
+     */
+    template <class Rep, class Period>
+    bool wait_pop_front(T& out, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+        while (!try_pop_front(out)) {
+            if (!wait_element(&deadline))
+                return try_pop_front(out);
+        }
+        return true;
+    }
+    template <class Rep, class Period>
+    bool wait_pop_back(T& out, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+        while (!try_pop_back(out)) {
+            if (!wait_element(&deadline))
+                return try_pop_back(out);
+        }
+        return true;
+    }
+
+    /**
+     * a copy of the index-th element.
+     * throw index_out_of_bound if out of bound.
+     * the operations in the middle take both locks, insert and erase
+     * move the elements between index and the nearer end
+     */
+    T at(size_t index)
+    {
+        std::lock_guard<std::mutex> front_guard(head.lock);
+        std::lock_guard<std::mutex> back_guard(tail.lock);
+        if (index >= count.load())
+            throw index_out_of_bound();
+        return *cursor(index);
+    }
+    /**
+     * insert value before the index-th element, index == size() adds it
+     * to the end.
+     * throw index_out_of_bound if index > size().
+     */
+    void insert(size_t index, T value)
+    {
+        std::lock_guard<std::mutex> front_guard(head.lock);
+        std::lock_guard<std::mutex> back_guard(tail.lock);
+        size_t n = count.load();
+        if (index > n)
+            throw index_out_of_bound();
+        if (index == 0) {
+            place_front(std::move(value));
+            return;
+        }
+        if (index == n) {
+            place_back(std::move(value));
+            return;
+        }
+        if (index < n / 2) {
+            place_front(std::move(*first()));
+            Cursor cur = cursor(1);
+            for (size_t i = 1; i < index; i++) {
+                Cursor from = cur;
+                from.next();
+                *cur = std::move(*from);
+                cur = from;
+            }
+            *cur = std::move(value);
+        } else {
+            Cursor cur = cursor(n - 1);
+            place_back(std::move(*cur));
+            for (size_t i = n - 1; i > index; i--) {
+                Cursor from = cur;
+                from.prev();
+                *cur = std::move(*from);
+                cur = from;
+            }
+            *cur = std::move(value);
+        }
+        return;
+    }
+    /**
+     * remove the index-th element.
+     * throw index_out_of_bound if out of bound.
+     */
+    void erase(size_t index)
+    {
+        std::lock_guard<std::mutex> front_guard(head.lock);
+        std::lock_guard<std::mutex> back_guard(tail.lock);
+        size_t n = count.load();
+        if (index >= n)
+            throw index_out_of_bound();
+        if (index < n / 2) {
+            Cursor cur = cursor(index);
+            for (size_t i = index; i > 0; i--) {
+                Cursor from = cur;
+                from.prev();
+                *cur = std::move(*from);
+                cur = from;
+            }
+            count--;
+            first()->~T();
+            head.idx++;
+        } else {
+            Cursor cur = cursor(index);
+            for (size_t i = index; i + 1 < n; i++) {
+                Cursor from = cur;
+                from.next();
+                *cur = std::move(*from);
+                cur = from;
+            }
+            count--;
+            last()->~T();
+            tail.idx--;
+        }
+        return;
+    }
+    /**
+     * remove all the elements
+     */
+    void clear()
+    {
+        std::lock_guard<std::mutex> front_guard(head.lock);
+        std::lock_guard<std::mutex> back_guard(tail.lock);
+        for (size_t n = count.load(); n > 0; n--) {
+            count--;
+            first()->~T();
+            head.idx++;
+        }
+        return;
+    }
+};
+
+} // namespace sjtu
+
+#endif
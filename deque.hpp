@@ -2,66 +2,426 @@
 #define SJTU_DEQUE_HPP
 
 #include "exceptions.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstddef>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+#if defined(__has_include)
+#if __has_include(<memory_resource>) && __cplusplus >= 201703L
+#include <memory_resource>
+#endif
+#endif
+
+/**
+ * how much the iterators check before each step and access
+ * 0: nothing, using an invalid iterator is undefined behaviour
+ * 1: the iterator points at an element of its container (the default)
+ * 2: deque iterators also carry a generation stamp, so an iterator used
+ *    after the deque has been modified throws invalid_iterator
+ */
+#ifndef SJTU_ITERATOR_CHECKS
+#define SJTU_ITERATOR_CHECKS 1
+#endif
 
 namespace sjtu {
-template <class T>
+constexpr int iterator_checks = SJTU_ITERATOR_CHECKS;
+/**
+ * create and delete an internal object of type U with the memory of
+ * alloc, rebound to U
+ * the object is constructed in place, the allocator is not passed to it
+ */
+template <class U, class Alloc, class... Args>
+U* allocator_new(const Alloc& alloc, Args&&... args)
+{
+    using traits = typename std::allocator_traits<Alloc>::template rebind_traits<U>;
+    typename traits::allocator_type a(alloc);
+    U* p = traits::allocate(a, 1);
+    try {
+        ::new ((void*)p) U(std::forward<Args>(args)...);
+    } catch (...) {
+        traits::deallocate(a, p, 1);
+        throw;
+    }
+    return p;
+}
+template <class U, class Alloc>
+void allocator_delete(const Alloc& alloc, U* p)
+{
+    if (p == nullptr)
+        return;
+    using traits = typename std::allocator_traits<Alloc>::template rebind_traits<U>;
+    typename traits::allocator_type a(alloc);
+    p->~U();
+    traits::deallocate(a, p, 1);
+    return;
+}
+/**
+ * assign from to the allocator to if the tag says it propagates
+ */
+template <class Alloc>
+void propagate_allocator(Alloc& to, const Alloc& from, std::true_type)
+{
+    to = from;
+    return;
+}
+template <class Alloc>
+void propagate_allocator(Alloc&, const Alloc&, std::false_type)
+{
+    return;
+}
+/**
+ * exchange the allocators a and b if the tag says they propagate
+ */
+template <class Alloc>
+void swap_allocator(Alloc& a, Alloc& b, std::true_type) noexcept
+{
+    using std::swap;
+    swap(a, b);
+    return;
+}
+template <class Alloc>
+void swap_allocator(Alloc&, Alloc&, std::false_type) noexcept
+{
+    return;
+}
+/**
+ * a slab pool of objects of type Obj
+ * memory is taken from the system in chunks of growing size, and freed
+ * slots are kept in a free list for reuse.
+ * the pool is deleted once its owner has released it and all the slots
+ * are given back, so slots may outlive the owner (e.g. nodes moved to
+ * another double_list by split or merge).
+ * not synchronized, the owners sharing slots must be on one thread.
+ */
+template <class Obj, class Alloc = std::allocator<Obj>>
+class slab_pool {
+private:
+    union Slot {
+        Slot* next;
+        alignas(Obj) unsigned char buf[sizeof(Obj)];
+    };
+    struct Chunk {
+        Chunk* next;
+        Slot* slots;
+        size_t cnt;
+    };
+    using slot_traits = typename std::allocator_traits<Alloc>::template rebind_traits<Slot>;
+    Slot* free_slots;
+    Chunk* chunks;
+    size_t chunk_size, live;
+    bool owned;
+    Alloc alloc;
+
+    explicit slab_pool(const Alloc& alloc)
+        : free_slots(nullptr)
+        , chunks(nullptr)
+        , chunk_size(16)
+        , live(0)
+        , owned(true)
+        , alloc(alloc)
+    {
+    }
+    ~slab_pool()
+    {
+        typename slot_traits::allocator_type a(alloc);
+        while (chunks != nullptr) {
+            Chunk* temp = chunks->next;
+            slot_traits::deallocate(a, chunks->slots, chunks->cnt);
+            allocator_delete(alloc, chunks);
+            chunks = temp;
+        }
+    }
+    /**
+     * delete the pool itself with its own allocator
+     */
+    void dispose()
+    {
+        using traits = typename std::allocator_traits<Alloc>::template rebind_traits<slab_pool>;
+        typename traits::allocator_type a(alloc);
+        this->~slab_pool();
+        traits::deallocate(a, this, 1);
+        return;
+    }
+    /**
+     * take a new chunk, twice as large as the last one, up to 64KB
+     */
+    void grow()
+    {
+        typename slot_traits::allocator_type a(alloc);
+        Slot* slots = slot_traits::allocate(a, chunk_size);
+        try {
+            chunks = allocator_new<Chunk>(alloc, Chunk { chunks, slots, chunk_size });
+        } catch (...) {
+            slot_traits::deallocate(a, slots, chunk_size);
+            throw;
+        }
+        for (size_t i = 0; i < chunk_size; i++) {
+            chunks->slots[i].next = free_slots;
+            free_slots = chunks->slots + i;
+        }
+        if (chunk_size * 2 * sizeof(Slot) <= 65536)
+            chunk_size *= 2;
+        return;
+    }
+
+public:
+    static slab_pool* create(const Alloc& alloc = Alloc())
+    {
+        using traits = typename std::allocator_traits<Alloc>::template rebind_traits<slab_pool>;
+        typename traits::allocator_type a(alloc);
+        return ::new ((void*)traits::allocate(a, 1)) slab_pool(alloc);
+    }
+    Alloc get_allocator() const
+    {
+        return alloc;
+    }
+    /**
+     * the owner gives up the pool
+     */
+    void release()
+    {
+        owned = false;
+        if (live == 0)
+            dispose();
+        return;
+    }
+    void* allocate()
+    {
+        if (free_slots == nullptr)
+            grow();
+        Slot* res = free_slots;
+        free_slots = res->next;
+        live++;
+        return res;
+    }
+    void deallocate(void* p)
+    {
+        Slot* cur = static_cast<Slot*>(p);
+        cur->next = free_slots;
+        free_slots = cur;
+        live--;
+        if (!owned && live == 0)
+            dispose();
+        return;
+    }
+};
+template <class T, class Allocator = std::allocator<T>>
 class double_list {
 private:
     /**
      * the nodes of double_list
+     * a value inserted by reference is stored inline in the node,
+     * a value inserted by pointer is owned by the node.
+     * each node remembers the pool it comes from.
      */
+    struct Node;
+    using pool_type = slab_pool<Node, Allocator>;
+    using traits = std::allocator_traits<Allocator>;
     struct Node {
         T* val;
         Node *pre, *nxt;
-        Node(T* val, Node* pre = nullptr, Node* nxt = nullptr)
+        pool_type* pool;
+        alignas(T) unsigned char buf[sizeof(T)];
+        Node(T* val, pool_type* pool)
             : val(val)
-            , pre(pre)
-            , nxt(nxt)
-        {
-        }
-        ~Node()
+            , pre(nullptr)
+            , nxt(nullptr)
+            , pool(pool)
         {
-            if (val != nullptr)
-                delete val;
         }
     };
     Node *head, *tail;
     size_t sz;
+    pool_type* pool;
+    Allocator alloc;
+    /**
+     * the node tail points to, kept inside the list so that an empty
+     * list owns no memory and moving a list doesn't allocate
+     */
+    Node sentinel;
+
+    /**
+     * take a node from the pool, holding a value constructed from args
+     * or owning the pointer val
+     */
+    template <class... Args>
+    Node* new_node(Args&&... args)
+    {
+        Node* cur = new_node_ptr(nullptr);
+        try {
+            T* p = reinterpret_cast<T*>(cur->buf);
+            traits::construct(alloc, p, std::forward<Args>(args)...);
+            cur->val = p;
+        } catch (...) {
+            delete_node(cur);
+            throw;
+        }
+        return cur;
+    }
+    Node* new_node_ptr(T* val)
+    {
+        if (pool == nullptr)
+            pool = pool_type::create(alloc);
+        return new (pool->allocate()) Node(val, pool);
+    }
+    /**
+     * destroy the value of a node and give the node back to the pool
+     * it comes from, with the allocator of that pool
+     */
+    static void delete_node(Node* p)
+    {
+        pool_type* origin = p->pool;
+        if (p->val == reinterpret_cast<T*>(p->buf)) {
+            Allocator a(origin->get_allocator());
+            traits::destroy(a, p->val);
+        } else if (p->val != nullptr)
+            delete p->val;
+        p->~Node();
+        origin->deallocate(p);
+        return;
+    }
+    /**
+     * link the n nodes from first to last into this empty list
+     */
+    void adopt(Node* first, Node* last, size_t n)
+    {
+        head = first;
+        first->pre = nullptr;
+        last->nxt = tail;
+        tail->pre = last;
+        sz = n;
+        return;
+    }
+    /**
+     * forget all the nodes, which now belong to another list
+     */
+    void reset()
+    {
+        head = tail;
+        tail->pre = nullptr;
+        sz = 0;
+        return;
+    }
 
 public:
+    using allocator_type = Allocator;
+
     /**
      * constructors and destructors
      * here we denote tail as a node points to nothing
+     * the pool is created by the first insertion
      */
     double_list()
+        : double_list(Allocator())
     {
-        head = tail = new Node(nullptr);
-        sz = 0;
     }
-    double_list(const double_list<T>& other)
+    explicit double_list(const Allocator& alloc)
+        : pool(nullptr)
+        , alloc(alloc)
+        , sentinel(nullptr, nullptr)
     {
-        head = tail = new Node(nullptr);
+        head = tail = &sentinel;
         sz = 0;
+    }
+    double_list(const double_list& other)
+        : double_list(traits::select_on_container_copy_construction(other.alloc))
+    {
         for (const_iterator it = other.cbegin(); it != other.cend(); it++)
             insert_tail(*it);
     }
+    /**
+     * take the nodes and the pool of other in O(1), other is left empty
+     */
+    double_list(double_list&& other) noexcept
+        : double_list(other.alloc)
+    {
+        pool = other.pool;
+        other.pool = nullptr;
+        if (!other.empty())
+            adopt(other.head, other.tail->pre, other.sz);
+        other.reset();
+    }
     ~double_list()
     {
         destroy();
+        if (pool != nullptr)
+            pool->release();
     }
+    /**
+     * the allocator of other is taken if it propagates on copy assignment
+     */
     double_list& operator=(const double_list& other)
     {
         if (this == &other)
             return *this;
-        clear();
+        if (traits::propagate_on_container_copy_assignment::value && alloc != other.alloc) {
+            destroy();
+            if (pool != nullptr)
+                pool->release();
+            pool = nullptr;
+            propagate_allocator(alloc, other.alloc, typename traits::propagate_on_container_copy_assignment());
+        } else
+            clear();
         for (const_iterator it = other.cbegin(); it != other.cend(); it++)
             insert_tail(*it);
         sz = other.sz;
         return *this;
     }
+    /**
+     * take the nodes and the pool of other in O(1) if the allocator
+     * propagates on move assignment or both allocators are equal,
+     * otherwise move the elements one by one
+     */
+    double_list& operator=(double_list&& other) noexcept(traits::propagate_on_container_move_assignment::value || traits::is_always_equal::value)
+    {
+        if (this == &other)
+            return *this;
+        using propagate = typename traits::propagate_on_container_move_assignment;
+        if (!propagate::value && alloc != other.alloc) {
+            clear();
+            for (iterator it = other.begin(); it != other.end(); it++)
+                emplace_tail(std::move(*it));
+            other.clear();
+            return *this;
+        }
+        destroy();
+        if (pool != nullptr)
+            pool->release();
+        pool = other.pool;
+        other.pool = nullptr;
+        propagate_allocator(alloc, other.alloc, propagate());
+        if (!other.empty())
+            adopt(other.head, other.tail->pre, other.sz);
+        other.reset();
+        return *this;
+    }
+    /**
+     * exchange the contents of two lists in O(1)
+     * the allocators are exchanged if they propagate on swap, otherwise
+     * they should be equal
+     */
+    void swap(double_list& other) noexcept
+    {
+        Node *first = head, *last = tail->pre;
+        size_t n = sz;
+        reset();
+        if (!other.empty())
+            adopt(other.head, other.tail->pre, other.sz);
+        other.reset();
+        if (n != 0)
+            other.adopt(first, last, n);
+        std::swap(pool, other.pool);
+        swap_allocator(alloc, other.alloc, typename traits::propagate_on_container_swap());
+        return;
+    }
 
     /**
      * the iterator of double_list
@@ -73,10 +433,10 @@ public:
 
     protected:
         Node* p;
-        const double_list<T>* base;
+        const double_list* base;
 
     public:
-        iterator(Node* p = nullptr, const double_list<T>* base = nullptr)
+        iterator(Node* p = nullptr, const double_list* base = nullptr)
             : p(p)
             , base(base)
         {
@@ -110,7 +470,7 @@ public:
          */
         iterator operator++(int)
         {
-            if (p == nullptr || p->nxt == nullptr)
+            if (iterator_checks >= 1 && (p == nullptr || p->nxt == nullptr))
                 throw invalid_iterator();
             Node* temp = p;
             p = p->nxt;
@@ -121,7 +481,7 @@ public:
          */
         iterator& operator++()
         {
-            if (p == nullptr || p->nxt == nullptr)
+            if (iterator_checks >= 1 && (p == nullptr || p->nxt == nullptr))
                 throw invalid_iterator();
             p = p->nxt;
             return *this;
@@ -131,7 +491,7 @@ public:
          */
         iterator operator--(int)
         {
-            if (p == nullptr || p->pre == nullptr)
+            if (iterator_checks >= 1 && (p == nullptr || p->pre == nullptr))
                 throw invalid_iterator();
             Node* temp = p;
             p = p->pre;
@@ -142,18 +502,18 @@ public:
          */
         iterator& operator--()
         {
-            if (p == nullptr || p->pre == nullptr)
+            if (iterator_checks >= 1 && (p == nullptr || p->pre == nullptr))
                 throw invalid_iterator();
             p = p->pre;
             return *this;
         }
         T* get() const
         {
-            if (p == nullptr)
+            if (iterator_checks >= 1 && p == nullptr)
                 throw invalid_iterator();
             return p->val;
         }
-        const double_list<T>* get_base() const
+        const double_list* get_base() const
         {
             return base;
         }
@@ -164,13 +524,13 @@ public:
          */
         T& operator*() const
         {
-            if (p == nullptr)
+            if (iterator_checks >= 1 && p == nullptr)
                 throw invalid_iterator();
             return *(p->val);
         }
-        T* operator->() const noexcept
+        T* operator->() const noexcept(iterator_checks == 0)
         {
-            if (p == nullptr)
+            if (iterator_checks >= 1 && p == nullptr)
                 throw invalid_iterator();
             return p->val;
         }
@@ -199,7 +559,7 @@ public:
 
     public:
         const_iterator() = default;
-        const_iterator(Node* p = nullptr, const double_list<T>* base = nullptr)
+        const_iterator(Node* p = nullptr, const double_list* base = nullptr)
             : iterator(p, base)
         {
         }
@@ -210,19 +570,19 @@ public:
         ~const_iterator() = default;
         const T& operator*() const
         {
-            if (this->p == nullptr)
+            if (iterator_checks >= 1 && this->p == nullptr)
                 throw invalid_iterator();
             return *(this->p->val);
         }
-        const T* operator->() const noexcept
+        const T* operator->() const noexcept(iterator_checks == 0)
         {
-            if (this->p == nullptr)
+            if (iterator_checks >= 1 && this->p == nullptr)
                 throw invalid_iterator();
             return this->p->val;
         }
         const T* get() const
         {
-            if (this->p == nullptr)
+            if (iterator_checks >= 1 && this->p == nullptr)
                 throw invalid_iterator();
             return this->p->val;
         }
@@ -276,19 +636,17 @@ public:
         return sz == 0;
     }
     /**
-     * destroy the whole double_list
-     * can't be used after destroy
+     * destroy all the nodes of the double_list
      */
     void destroy()
     {
         Node* temp = head;
         while (temp != tail) {
             Node* temp2 = temp->nxt;
-            delete temp;
+            delete_node(temp);
             temp = temp2;
         }
-        delete tail;
-        sz = 0;
+        reset();
         return;
     }
     /**
@@ -298,8 +656,6 @@ public:
     void clear()
     {
         destroy();
-        head = tail = new Node(nullptr);
-        sz = 0;
         return;
     }
     /**
@@ -312,15 +668,28 @@ public:
 
     /* insert an element after iterator pos */
     iterator insert(iterator pos, const T& val)
+    {
+        return emplace(pos, val);
+    }
+    iterator insert(iterator pos, T&& val)
+    {
+        return emplace(pos, std::move(val));
+    }
+    /**
+     * construct an element from args in its node, at the same place
+     * as insert
+     */
+    template <class... Args>
+    iterator emplace(iterator pos, Args&&... args)
     {
         if (pos.get_base() != this || pos.p == nullptr)
             throw invalid_iterator();
         if (pos == begin()) {
-            insert_head(val);
+            emplace_head(std::forward<Args>(args)...);
             return begin();
         }
+        Node* cur = new_node(std::forward<Args>(args)...);
         sz++;
-        Node* cur = new Node(new T(val));
         cur->nxt = pos.p;
         cur->pre = pos.p->pre;
         cur->nxt->pre = cur;
@@ -335,8 +704,8 @@ public:
             insert_head_ptr(val);
             return begin();
         }
+        Node* cur = new_node_ptr(val);
         sz++;
-        Node* cur = new Node(val);
         cur->nxt = pos.p;
         cur->pre = pos.p->pre;
         cur->nxt->pre = cur;
@@ -368,7 +737,7 @@ public:
             cur->pre->nxt = cur->nxt;
             cur->nxt->pre = cur->pre;
             pos++;
-            delete cur;
+            delete_node(cur);
             return pos;
         }
     }
@@ -395,8 +764,19 @@ public:
      */
     void insert_head(const T& val)
     {
+        emplace_head(val);
+        return;
+    }
+    void insert_head(T&& val)
+    {
+        emplace_head(std::move(val));
+        return;
+    }
+    template <class... Args>
+    void emplace_head(Args&&... args)
+    {
+        Node* cur = new_node(std::forward<Args>(args)...);
         sz++;
-        Node* cur = new Node(new T(val));
         cur->nxt = head;
         cur->nxt->pre = cur;
         head = cur;
@@ -404,8 +784,8 @@ public:
     }
     void insert_head_ptr(T* val)
     {
+        Node* cur = new_node_ptr(val);
         sz++;
-        Node* cur = new Node(val);
         cur->nxt = head;
         cur->nxt->pre = cur;
         head = cur;
@@ -416,7 +796,18 @@ public:
      */
     void insert_tail(const T& val)
     {
-        insert(end(), val);
+        emplace(end(), val);
+        return;
+    }
+    void insert_tail(T&& val)
+    {
+        emplace(end(), std::move(val));
+        return;
+    }
+    template <class... Args>
+    void emplace_tail(Args&&... args)
+    {
+        emplace(end(), std::forward<Args>(args)...);
         return;
     }
     void insert_tail_ptr(T* val)
@@ -435,7 +826,7 @@ public:
         Node* cur = head;
         head = head->nxt;
         head->pre = nullptr;
-        delete cur;
+        delete_node(cur);
         return;
     }
     /**
@@ -448,637 +839,2953 @@ public:
         erase(last());
         return;
     }
-    std::pair<double_list<T>*, double_list<T>*> split(size_t pos)
+    Allocator get_allocator() const
     {
-        double_list<T>* list1 = new double_list<T>();
-        double_list<T>* list2 = new double_list<T>();
-        if (pos == 0) {
-            list2->head = head;
-            delete list2->tail;
-            list2->tail = tail;
-            list2->sz = sz;
-            head = tail = new Node(nullptr);
-            sz = 0;
-            return std::make_pair(list1, list2);
-        }
-        if (pos >= sz) {
-            list1->head = head;
-            delete list1->tail;
-            list1->tail = tail;
-            list1->sz = sz;
-            head = tail = new Node(nullptr);
-            sz = 0;
+        return alloc;
+    }
+    /**
+     * the two lists returned are created by new, with the allocator
+     * of this list
+     */
+    std::pair<double_list*, double_list*> split(size_t pos)
+    {
+        double_list* list1 = new double_list(alloc);
+        double_list* list2 = new double_list(alloc);
+        if (pos == 0 || pos >= sz) {
+            if (!empty())
+                (pos == 0 ? list2 : list1)->adopt(head, tail->pre, sz);
+            reset();
             return std::make_pair(list1, list2);
         }
         auto it1 = begin() + pos - 1, it2 = begin() + pos;
-        list1->head = head;
-        list1->tail->pre = it1.p;
-        it1.p->nxt = list1->tail;
-        list1->sz = pos;
-        list2->head = it2.p;
-        delete list2->tail;
-        list2->tail = tail;
-        it2.p->pre = nullptr;
-        list2->sz = sz - pos;
-        head = tail = new Node(nullptr);
-        sz = 0;
+        list1->adopt(head, it1.p, pos);
+        list2->adopt(it2.p, tail->pre, sz - pos);
+        reset();
         return std::make_pair(list1, list2);
     }
-    void merge(double_list<T>* list)
+    void merge(double_list* list)
     {
-        if (empty()) {
-            head = list->head;
-            delete tail;
-            tail = list->tail;
-            sz = list->sz;
-            list->head = list->tail = new Node(nullptr);
-            list->sz = 0;
+        if (list->empty())
             return;
+        if (empty())
+            adopt(list->head, list->tail->pre, list->sz);
+        else {
+            Node* last = tail->pre;
+            last->nxt = list->head;
+            list->head->pre = last;
+            list->tail->pre->nxt = tail;
+            tail->pre = list->tail->pre;
+            sz += list->sz;
         }
-        auto it = last();
-        it.p->nxt = list->head;
-        list->head->pre = it.p;
-        delete tail;
-        tail = list->tail;
-        sz += list->sz;
-        list->head = list->tail = new Node(nullptr);
-        list->sz = 0;
+        list->reset();
         return;
     }
 };
-template <class T>
-class deque {
+/**
+ * exchange the contents of two lists, found by ADL
+ */
+template <class T, class Allocator>
+void swap(double_list<T, Allocator>& lhs, double_list<T, Allocator>& rhs) noexcept
+{
+    lhs.swap(rhs);
+    return;
+}
+/**
+ * a fixed-capacity ring buffer, used as one block of deque
+ * the elements are stored inline in one contiguous array,
+ * and may wrap around the end of it
+ * if N is not 0, the capacity is N for every buffer and known at compile
+ * time, and a power of two N turns the wrap around into a mask
+ * the storage and the elements are managed through Alloc
+ * a buffer may be shared by several owners, it counts the references
+ * and whoever drops the last one deletes it
+ */
+template <class T, size_t N = 0, class Alloc = std::allocator<T>>
+class ring_buffer {
 private:
-    double_list<double_list<T>>* block;
-    size_t length, sz;
-
-public:
-    class const_iterator;
-    class iterator {
-        friend deque;
+    using traits = std::allocator_traits<Alloc>;
+    T* data;
+    size_t cap, head, sz;
+    Alloc alloc;
+    std::atomic<size_t> refs;
 
-    protected:
-        /**
-         * add data members.
-         * just add whatever you want.
-         */
-        typename double_list<double_list<T>>::iterator block_it;
-        typename double_list<T>::iterator list_it;
-        const deque* base;
+    /**
+     * the physical index of the pos-th element
+     */
+    size_t slot(size_t pos) const
+    {
+        pos += head;
+        if (N != 0 && (N & (N - 1)) == 0)
+            return pos & (N - 1);
+        return pos >= capacity() ? pos - capacity() : pos;
+    }
+    /**
+     * the capacity to allocate for n elements
+     */
+    static size_t fit(size_t n)
+    {
+        return N != 0 ? N : std::max(n, (size_t)1);
+    }
+    T* allocate(size_t n)
+    {
+        return traits::allocate(alloc, n);
+    }
+    void deallocate(T* p, size_t n)
+    {
+        traits::deallocate(alloc, p, n);
+    }
+    template <class... Args>
+    void construct(T* p, Args&&... args)
+    {
+        traits::construct(alloc, p, std::forward<Args>(args)...);
+    }
+    void destroy(T* p)
+    {
+        traits::destroy(alloc, p);
+    }
 
-    public:
-        iterator() = default;
-        iterator(typename double_list<double_list<T>>::iterator block_it, typename double_list<T>::iterator list_it, const deque* base)
-            : block_it(block_it)
-            , list_it(list_it)
-            , base(base)
-        {
-        }
-        ~iterator() = default;
-        iterator(const iterator& other)
-            : block_it(other.block_it)
-            , list_it(other.list_it)
-            , base(other.base)
-        {
-        }
-        iterator operator=(const iterator& other)
-        {
-            block_it = other.block_it;
-            list_it = other.list_it;
-            base = other.base;
+public:
+    /**
+     * constructors and destructors
+     */
+    explicit ring_buffer(size_t cap = 1, const Alloc& alloc = Alloc())
+        : data(nullptr)
+        , cap(fit(cap))
+        , head(0)
+        , sz(0)
+        , alloc(alloc)
+        , refs(1)
+    {
+        data = allocate(this->cap);
+    }
+    ring_buffer(const ring_buffer& other)
+        : ring_buffer(other, other.alloc)
+    {
+    }
+    /**
+     * copy other into a buffer using alloc
+     */
+    ring_buffer(const ring_buffer& other, const Alloc& alloc)
+        : ring_buffer(other.sz, alloc)
+    {
+        for (size_t i = 0; i < other.sz; i++)
+            insert_tail(other[i]);
+    }
+    ~ring_buffer()
+    {
+        clear();
+        deallocate(data, cap);
+    }
+    ring_buffer& operator=(const ring_buffer& other)
+    {
+        if (this == &other)
             return *this;
+        clear();
+        if (cap < other.sz) {
+            T* temp = allocate(fit(other.sz));
+            deallocate(data, cap);
+            data = temp;
+            cap = fit(other.sz);
         }
+        for (size_t i = 0; i < other.sz; i++)
+            insert_tail(other[i]);
+        return *this;
+    }
 
-        /**
-         * return a new iterator which points to the n-next element.
-         * if there are not enough elements, the behaviour is undefined.
-         * same for operator-.
-         */
-        iterator operator+(const int& n) const
-        {
-            if (n < 0)
-                return *this - (-n);
-            typename double_list<double_list<T>>::iterator temp = block_it;
-            int cnt = n, pos = temp->get_pos(list_it);
-            while (temp != base->block->end() && pos + cnt >= temp->size()) {
-                cnt -= temp->size() - pos;
-                temp++;
-                pos = 0;
-            }
-            if (temp == base->block->end()) {
-                if (cnt)
-                    throw invalid_iterator();
-                return base->cend();
-            }
-            return iterator(temp, temp->begin() + (pos + cnt), base);
-        }
-        iterator operator-(const int& n) const
-        {
-            if (n < 0)
-                return *this + (-n);
-            typename double_list<double_list<T>>::iterator temp = block_it;
-            int cnt = n, pos = temp->get_pos(list_it);
-            while (pos - cnt < 0) {
-                cnt -= (pos + 1);
-                temp--;
-                pos = temp->size() - 1;
-            }
-            return iterator(temp, temp->begin() + (pos - cnt), base);
-        }
+    /**
+     * take / drop a reference to the buffer
+     * release returns true if it was the last one
+     */
+    void acquire()
+    {
+        refs.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    bool release()
+    {
+        return refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+    /**
+     * whether other owners hold the buffer, so it must not be modified
+     */
+    bool shared() const
+    {
+        return refs.load(std::memory_order_acquire) != 1;
+    }
 
-        /**
-         * return the distance between two iterators.
-         * if they point to different vectors, throw
-         * invaild_iterator.
-         */
-        int operator-(const iterator& rhs) const
-        {
-            if (base != rhs.base)
-                throw invalid_iterator();
-            size_t lpos = base->block->get_pos(block_it), rpos = rhs.base->block->get_pos(rhs.block_it);
-            if (lpos == rpos) {
-                return (int)block_it->get_pos(list_it) - (int)rhs.block_it->get_pos(rhs.list_it);
-            } else {
-                bool greater = lpos > rpos;
-                int cnt = 0;
-                auto temp = greater ? rhs : *this;
-                while (temp.block_it != (greater ? block_it : rhs.block_it)) {
-                    cnt += temp.block_it->size();
-                    temp.block_it++;
-                }
-                lpos = block_it->get_pos(list_it);
-                rpos = rhs.block_it->get_pos(rhs.list_it);
-                return greater ? cnt + lpos - rpos : -(cnt + rpos - lpos);
-            }
-        }
-        iterator& operator+=(const int& n)
-        {
-            iterator temp = (*this) + n;
-            *this = temp;
-            return *this;
-        }
-        iterator& operator-=(const int& n)
-        {
-            iterator temp = (*this) - n;
-            *this = temp;
-            return *this;
-        }
+    /**
+     * access the pos-th element, without bound checking
+     */
+    T& operator[](size_t pos)
+    {
+        return data[slot(pos)];
+    }
+    const T& operator[](size_t pos) const
+    {
+        return data[slot(pos)];
+    }
+    /**
+     * the number of elements from the pos-th one that are stored
+     * contiguously, until the end of the elements or of the storage
+     */
+    size_t contiguous(size_t pos) const
+    {
+        return std::min(sz - pos, capacity() - slot(pos));
+    }
 
-        /**
-         * iter++
-         */
-        iterator operator++(int)
-        {
-            if (*this == base->cend())
-                throw invalid_iterator();
-            iterator temp = *this;
-            if (list_it == block_it->last() && block_it != base->block->last()) {
-                block_it++;
-                list_it = block_it->begin();
-            } else
-                list_it++;
-            return temp;
-        }
-        /**
-         * ++iter
-         */
-        iterator& operator++()
-        {
-            if (*this == base->cend())
-                throw invalid_iterator();
-            if (list_it == block_it->last() && block_it != base->block->last()) {
-                block_it++;
-                list_it = block_it->begin();
-            } else
-                list_it++;
-            return *this;
-        }
-        /**
-         * iter--
-         */
-        iterator operator--(int)
-        {
-            iterator temp = *this;
-            if (list_it == block_it->begin()) {
-                block_it--;
-                list_it = block_it->last();
-            } else
-                list_it--;
-            return temp;
-        }
-        /**
-         * --iter
-         */
-        iterator& operator--()
-        {
-            if (list_it == block_it->begin()) {
-                block_it--;
-                list_it = block_it->last();
-            } else
-                list_it--;
-            return *this;
+    size_t size() const
+    {
+        return sz;
+    }
+    size_t capacity() const
+    {
+        return N != 0 ? N : cap;
+    }
+    bool empty() const
+    {
+        return sz == 0;
+    }
+    bool full() const
+    {
+        return sz == capacity();
+    }
+
+    /**
+     * destroy all the elements, the storage is kept
+     */
+    void clear()
+    {
+        for (size_t i = 0; i < sz; i++)
+            destroy(data + slot(i));
+        head = sz = 0;
+        return;
+    }
+    /**
+     * make the capacity at least n
+     * throw runtime_error if the capacity is fixed
+     */
+    void reserve(size_t n)
+    {
+        if (n <= capacity())
+            return;
+        if (N != 0)
+            throw runtime_error();
+        T* temp = allocate(n);
+        for (size_t i = 0; i < sz; i++) {
+            construct(temp + i, std::move(data[slot(i)]));
+            destroy(data + slot(i));
         }
+        deallocate(data, cap);
+        data = temp;
+        cap = n;
+        head = 0;
+        return;
+    }
 
-        T* get() const
-        {
-            if (*this == base->cend())
-                throw invalid_iterator();
-            return list_it.get();
+    /**
+     * construct an element from args at the head / tail of the buffer,
+     * in its final slot
+     * throw runtime_error if the buffer is full
+     */
+    template <class... Args>
+    void emplace_head(Args&&... args)
+    {
+        if (full())
+            throw runtime_error();
+        size_t pre = head == 0 ? capacity() - 1 : head - 1;
+        construct(data + pre, std::forward<Args>(args)...);
+        head = pre;
+        sz++;
+        return;
+    }
+    template <class... Args>
+    void emplace_tail(Args&&... args)
+    {
+        if (full())
+            throw runtime_error();
+        construct(data + slot(sz), std::forward<Args>(args)...);
+        sz++;
+        return;
+    }
+    void insert_head(const T& val)
+    {
+        emplace_head(val);
+        return;
+    }
+    void insert_tail(const T& val)
+    {
+        emplace_tail(val);
+        return;
+    }
+    void insert_tail(T&& val)
+    {
+        emplace_tail(std::move(val));
+        return;
+    }
+    /**
+     * construct an element from args before the pos-th element
+     * only the shorter side of the buffer is shifted
+     * in the middle, the element is built first and moved into the gap,
+     * so args may refer to an element of this buffer
+     */
+    template <class... Args>
+    void emplace(size_t pos, Args&&... args)
+    {
+        if (full() || pos > sz)
+            throw runtime_error();
+        if (pos == 0) {
+            emplace_head(std::forward<Args>(args)...);
+            return;
         }
-        /**
-         * *it
-         */
-        T& operator*() const
-        {
-            if (*this == base->cend())
-                throw invalid_iterator();
-            return *list_it;
+        if (pos == sz) {
+            emplace_tail(std::forward<Args>(args)...);
+            return;
         }
-        /**
-         * it->field
-         */
-        T* operator->() const noexcept
-        {
-            if (*this == base->cend())
-                throw invalid_iterator();
-            return list_it.get();
+        T temp(std::forward<Args>(args)...);
+        if (pos < sz - pos) {
+            size_t pre = head == 0 ? capacity() - 1 : head - 1;
+            construct(data + pre, std::move((*this)[0]));
+            for (size_t i = 1; i < pos; i++)
+                (*this)[i - 1] = std::move((*this)[i]);
+            (*this)[pos - 1] = std::move(temp);
+            head = pre;
+        } else {
+            construct(data + slot(sz), std::move((*this)[sz - 1]));
+            for (size_t i = sz - 1; i > pos; i--)
+                (*this)[i] = std::move((*this)[i - 1]);
+            (*this)[pos] = std::move(temp);
         }
+        sz++;
+        return;
+    }
+    void insert(size_t pos, const T& val)
+    {
+        emplace(pos, val);
+        return;
+    }
 
-        /**
-         * check whether two iterators are the same (pointing to the same
-         * memory).
-         */
-        bool operator==(const iterator& rhs) const
-        {
-            return block_it == rhs.block_it && list_it == rhs.list_it && base == rhs.base;
-        }
-        bool operator==(const const_iterator& rhs) const
-        {
-            return block_it == rhs.block_it && list_it == rhs.list_it && base == rhs.base;
-        }
-        /**
-         * some other operator for iterators.
-         */
-        bool operator!=(const iterator& rhs) const
-        {
-            return block_it != rhs.block_it || list_it != rhs.list_it || base != rhs.base;
+    /**
+     * delete the head / tail of the buffer
+     */
+    void delete_head()
+    {
+        if (empty())
+            throw container_is_empty();
+        destroy(data + head);
+        head = slot(1);
+        sz--;
+        return;
+    }
+    void delete_tail()
+    {
+        if (empty())
+            throw container_is_empty();
+        destroy(data + slot(sz - 1));
+        sz--;
+        return;
+    }
+    /**
+     * erase the pos-th element
+     * only the shorter side of the buffer is shifted
+     */
+    void erase(size_t pos)
+    {
+        if (pos >= sz)
+            throw runtime_error();
+        if (pos < sz - pos - 1) {
+            for (size_t i = pos; i > 0; i--)
+                (*this)[i] = std::move((*this)[i - 1]);
+            delete_head();
+        } else {
+            for (size_t i = pos; i + 1 < sz; i++)
+                (*this)[i] = std::move((*this)[i + 1]);
+            delete_tail();
         }
-        bool operator!=(const const_iterator& rhs) const
-        {
-            return block_it != rhs.block_it || list_it != rhs.list_it || base != rhs.base;
+        return;
+    }
+    /**
+     * erase cnt elements from the pos-th one
+     * only the shorter side of the buffer is shifted
+     */
+    void erase(size_t pos, size_t cnt)
+    {
+        if (pos + cnt > sz)
+            throw runtime_error();
+        if (pos < sz - pos - cnt) {
+            for (size_t i = pos; i > 0; i--)
+                (*this)[i + cnt - 1] = std::move((*this)[i - 1]);
+            for (size_t i = 0; i < cnt; i++)
+                delete_head();
+        } else {
+            for (size_t i = pos; i + cnt < sz; i++)
+                (*this)[i] = std::move((*this)[i + cnt]);
+            for (size_t i = 0; i < cnt; i++)
+                delete_tail();
         }
+        return;
+    }
+
+    /**
+     * move the elements from pos to the end into the empty buffer other,
+     * and return it
+     */
+    ring_buffer* split(size_t pos, ring_buffer* other)
+    {
+        for (size_t i = pos; i < sz; i++)
+            other->insert_tail(std::move((*this)[i]));
+        while (sz > pos)
+            delete_tail();
+        return other;
+    }
+    /**
+     * move all the elements of other to the end of this buffer
+     * other is left empty
+     */
+    void merge(ring_buffer* other)
+    {
+        reserve(sz + other->sz);
+        for (size_t i = 0; i < other->sz; i++)
+            insert_tail(std::move((*other)[i]));
+        other->clear();
+        return;
+    }
+};
+/**
+ * the directory of the blocks of deque
+ * a centered array of block pointers, each with a key, so that
+ * the number of elements in front of block i is key[i] - key[0]
+ * blocks can be located by binary search on the keys
+ * the entries and the blocks are allocated with Alloc, the allocator of
+ * the elements, and each block is given a copy of it
+ * a copy may share the blocks of the original if their allocators are
+ * equal, the blocks count their owners and are deleted by the last one
+ */
+template <class Block, class Alloc>
+class block_map {
+private:
+    struct Entry {
+        Block* blk;
+        size_t key;
     };
+    using entry_traits = typename std::allocator_traits<Alloc>::template rebind_traits<Entry>;
+    Entry* map;
+    size_t cap, head, cnt;
+    Alloc alloc;
 
-    class const_iterator : public iterator {
-        friend deque;
+    /**
+     * make sure there is a free entry on both sides
+     */
+    void reserve()
+    {
+        if (head != 0 && head + cnt != cap)
+            return;
+        size_t new_cap = std::max(cap, cnt * 2 + 8);
+        typename entry_traits::allocator_type a(alloc);
+        Entry* temp = entry_traits::allocate(a, new_cap);
+        size_t new_head = (new_cap - cnt) / 2;
+        std::uninitialized_copy(map + head, map + head + cnt, temp + new_head);
+        if (map != nullptr)
+            entry_traits::deallocate(a, map, cap);
+        map = temp;
+        cap = new_cap;
+        head = new_head;
+        return;
+    }
 
-    public:
-        const_iterator() = default;
-        const_iterator(const iterator& t)
-            : iterator(t)
-        {
+public:
+    /**
+     * constructors and destructors
+     * the blocks are owned by the map
+     */
+    explicit block_map(const Alloc& alloc = Alloc())
+        : map(nullptr)
+        , cap(0)
+        , head(0)
+        , cnt(0)
+        , alloc(alloc)
+    {
+    }
+    block_map(const block_map& other)
+        : block_map(other, other.alloc, false)
+    {
+    }
+    /**
+     * take the entries of other, other is left with no blocks
+     */
+    block_map(block_map&& other) noexcept
+        : map(other.map)
+        , cap(other.cap)
+        , head(other.head)
+        , cnt(other.cnt)
+        , alloc(other.alloc)
+    {
+        other.map = nullptr;
+        other.cap = other.head = other.cnt = 0;
+    }
+    /**
+     * copy the blocks of other with alloc, or share them if shared is set
+     * and alloc equals the allocator of other
+     */
+    block_map(const block_map& other, const Alloc& alloc, bool shared)
+        : block_map(alloc)
+    {
+        for (size_t i = 0; i < other.cnt; i++)
+            insert(cnt, shared ? share(other[i], other.alloc) : create(*other[i], alloc));
+    }
+    ~block_map()
+    {
+        clear();
+        if (map != nullptr) {
+            typename entry_traits::allocator_type a(alloc);
+            entry_traits::deallocate(a, map, cap);
         }
-        const_iterator(typename double_list<double_list<T>>::iterator block_it, typename double_list<T>::iterator list_it, const deque* base)
-            : iterator(block_it, list_it, base)
-        {
+    }
+    block_map& operator=(const block_map& other)
+    {
+        if (this == &other)
+            return *this;
+        clear();
+        for (size_t i = 0; i < other.cnt; i++)
+            insert(cnt, create(*other[i], alloc));
+        return *this;
+    }
+    /**
+     * exchange the entries with other, the allocators are exchanged
+     * if Propagate is std::true_type, otherwise they should be equal
+     */
+    template <class Propagate>
+    void swap(block_map& other, Propagate) noexcept
+    {
+        std::swap(map, other.map);
+        std::swap(cap, other.cap);
+        std::swap(head, other.head);
+        std::swap(cnt, other.cnt);
+        swap_allocator(alloc, other.alloc, Propagate());
+        return;
+    }
+
+    /**
+     * create a block with the allocator of the map
+     * args are passed to the constructor of the block
+     */
+    template <class... Args>
+    Block* create(Args&&... args) const
+    {
+        return allocator_new<Block>(alloc, std::forward<Args>(args)...);
+    }
+    /**
+     * take a reference to blk, owned by a map using blk_alloc
+     * blocks are only shared between equal allocators, otherwise
+     * blk is copied
+     */
+    Block* share(Block* blk, const Alloc& blk_alloc) const
+    {
+        if (!(alloc == blk_alloc))
+            return create(*blk, alloc);
+        blk->acquire();
+        return blk;
+    }
+    /**
+     * drop a reference to blk, and delete it if it was the last one
+     */
+    void destroy(Block* blk) const
+    {
+        if (blk != nullptr && blk->release())
+            allocator_delete(alloc, blk);
+        return;
+    }
+    /**
+     * replace the i-th block by blk with the same size, and return
+     * the old one
+     */
+    Block* replace(size_t i, Block* blk)
+    {
+        Block* res = map[head + i].blk;
+        map[head + i].blk = blk;
+        return res;
+    }
+
+    /**
+     * the number of blocks
+     */
+    size_t size() const
+    {
+        return cnt;
+    }
+    bool empty() const
+    {
+        return cnt == 0;
+    }
+    /**
+     * the i-th block
+     */
+    Block* operator[](size_t i) const
+    {
+        return map[head + i].blk;
+    }
+    /**
+     * the number of elements in front of the i-th block
+     */
+    size_t start(size_t i) const
+    {
+        return map[head + i].key - map[head].key;
+    }
+    /**
+     * the last block whose start is not greater than index
+     */
+    size_t locate(size_t index) const
+    {
+        size_t l = 0, r = cnt - 1;
+        while (l < r) {
+            size_t mid = (l + r + 1) / 2;
+            if (start(mid) <= index)
+                l = mid;
+            else
+                r = mid - 1;
         }
-        ~const_iterator() = default;
-        const T* get() const
-        {
-            if (*this == this->base->cend())
-                throw invalid_iterator();
-            return this->list_it.get();
+        return l;
+    }
+
+    /**
+     * delete all the blocks
+     */
+    void clear()
+    {
+        for (size_t i = 0; i < cnt; i++)
+            destroy(map[head + i].blk);
+        head = cap / 2;
+        cnt = 0;
+        return;
+    }
+    /**
+     * the i-th block has gained delta elements (maybe negative)
+     * only the keys on the shorter side are updated
+     */
+    void adjust(size_t i, long long delta)
+    {
+        if (i + 1 < cnt - i - 1) {
+            for (size_t j = 0; j <= i; j++)
+                map[head + j].key -= delta;
+        } else {
+            for (size_t j = i + 1; j < cnt; j++)
+                map[head + j].key += delta;
+        }
+        return;
+    }
+    /**
+     * delta elements have been moved from the (i + 1)-th block
+     * to the end of the i-th block
+     */
+    void transfer(size_t i, long long delta)
+    {
+        map[head + i + 1].key += delta;
+        return;
+    }
+    /**
+     * insert blk so that it becomes the i-th block
+     * only the entries on the shorter side are moved
+     */
+    void insert(size_t i, Block* blk)
+    {
+        reserve();
+        size_t s = blk->size();
+        if (i == cnt) {
+            size_t key = cnt ? map[head + cnt - 1].key + map[head + cnt - 1].blk->size() : 0;
+            map[head + cnt] = Entry { blk, key };
+        } else if (i < cnt - i) {
+            size_t key = map[head + i].key - s;
+            for (size_t j = 0; j < i; j++) {
+                map[head + j - 1] = map[head + j];
+                map[head + j - 1].key -= s;
+            }
+            head--;
+            map[head + i] = Entry { blk, key };
+        } else {
+            size_t key = map[head + i].key;
+            for (size_t j = cnt; j > i; j--) {
+                map[head + j] = map[head + j - 1];
+                map[head + j].key += s;
+            }
+            map[head + i] = Entry { blk, key };
+        }
+        cnt++;
+        return;
+    }
+    /**
+     * erase and delete the i-th block
+     */
+    void erase(size_t i)
+    {
+        destroy(release(i));
+        return;
+    }
+    /**
+     * remove the i-th block and return it, without deleting it
+     * only the entries on the shorter side are moved
+     */
+    Block* release(size_t i)
+    {
+        Block* res = map[head + i].blk;
+        size_t s = res->size();
+        if (i < cnt - i - 1) {
+            for (size_t j = i; j > 0; j--) {
+                map[head + j] = map[head + j - 1];
+                map[head + j].key += s;
+            }
+            head++;
+        } else {
+            for (size_t j = i; j + 1 < cnt; j++) {
+                map[head + j] = map[head + j + 1];
+                map[head + j].key -= s;
+            }
+        }
+        cnt--;
+        return res;
+    }
+    /**
+     * erase and delete the blocks from first to last (not included)
+     * only the entries on the shorter side are moved
+     */
+    void erase(size_t first, size_t last)
+    {
+        size_t c = last - first, s = 0;
+        for (size_t i = first; i < last; i++) {
+            s += map[head + i].blk->size();
+            destroy(map[head + i].blk);
+        }
+        if (first < cnt - last) {
+            for (size_t j = first; j > 0; j--) {
+                map[head + j - 1 + c] = map[head + j - 1];
+                map[head + j - 1 + c].key += s;
+            }
+            head += c;
+        } else {
+            for (size_t j = last; j < cnt; j++) {
+                map[head + j - c] = map[head + j];
+                map[head + j - c].key -= s;
+            }
+        }
+        cnt -= c;
+        return;
+    }
+};
+/**
+ * another directory of the blocks of deque, with the interface of block_map
+ * a B+ tree whose leaves hold the block pointers, each child is stored
+ * with the number of blocks and elements below it, so that locating,
+ * inserting and removing a block cost O(log(n)) instead of moving the
+ * entries of an array
+ * an insertion first splits the full nodes on its path and only then
+ * updates the counts, and a node left with too few children is merged
+ * with or refilled from a neighbour, so only a split allocates and a
+ * failed one leaves the counts as they were
+ */
+template <class Block, class Alloc>
+class block_tree {
+private:
+    enum : size_t {
+        fanout = 32,
+        min_fill = fanout / 4
+    };
+    struct Node;
+    /**
+     * a child of a node, a subtree in an inner node or a block in a leaf
+     */
+    struct Slot {
+        Node* child;
+        Block* blk;
+        size_t blocks, elems;
+    };
+    struct Node {
+        bool leaf;
+        size_t cnt;
+        Slot slot[fanout];
+        explicit Node(bool leaf)
+            : leaf(leaf)
+            , cnt(0)
+        {
+        }
+    };
+    Node* root;
+    size_t cnt;
+    Alloc alloc;
+
+    /**
+     * the slot of the parent of n, counting the blocks and elements below n
+     */
+    static Slot summary(Node* n)
+    {
+        Slot res { n, nullptr, 0, 0 };
+        for (size_t i = 0; i < n->cnt; i++) {
+            res.blocks += n->slot[i].blocks;
+            res.elems += n->slot[i].elems;
+        }
+        return res;
+    }
+    /**
+     * split the full c-th child of n into two halves
+     */
+    void split(Node* n, size_t c)
+    {
+        Node* cur = n->slot[c].child;
+        Node* next = allocator_new<Node>(alloc, cur->leaf);
+        next->cnt = cur->cnt - cur->cnt / 2;
+        cur->cnt /= 2;
+        std::copy(cur->slot + cur->cnt, cur->slot + cur->cnt + next->cnt, next->slot);
+        std::copy_backward(n->slot + c + 1, n->slot + n->cnt, n->slot + n->cnt + 1);
+        n->slot[c] = summary(cur);
+        n->slot[c + 1] = summary(next);
+        n->cnt++;
+        return;
+    }
+    /**
+     * the c-th child of n has too few children, merge it with a
+     * neighbour, or move children from the neighbour if they don't fit
+     */
+    void refill(Node* n, size_t c)
+    {
+        size_t l = c + 1 < n->cnt ? c : c - 1;
+        Node* left = n->slot[l].child;
+        Node* right = n->slot[l + 1].child;
+        if (left->cnt + right->cnt <= fanout) {
+            std::copy(right->slot, right->slot + right->cnt, left->slot + left->cnt);
+            left->cnt += right->cnt;
+            allocator_delete(alloc, right);
+            std::copy(n->slot + l + 2, n->slot + n->cnt, n->slot + l + 1);
+            n->cnt--;
+            n->slot[l] = summary(left);
+            return;
+        }
+        size_t total = left->cnt + right->cnt, half = total / 2;
+        if (left->cnt < half) {
+            size_t k = half - left->cnt;
+            std::copy(right->slot, right->slot + k, left->slot + left->cnt);
+            std::copy(right->slot + k, right->slot + right->cnt, right->slot);
+        } else {
+            size_t k = left->cnt - half;
+            std::copy_backward(right->slot, right->slot + right->cnt, right->slot + right->cnt + k);
+            std::copy(left->slot + half, left->slot + left->cnt, right->slot);
+        }
+        left->cnt = half;
+        right->cnt = total - half;
+        n->slot[l] = summary(left);
+        n->slot[l + 1] = summary(right);
+        return;
+    }
+    /**
+     * remove the i-th block below n
+     */
+    Block* remove(Node* n, size_t i)
+    {
+        size_t c = 0;
+        while (i >= n->slot[c].blocks)
+            i -= n->slot[c++].blocks;
+        if (n->leaf) {
+            Block* res = n->slot[c].blk;
+            std::copy(n->slot + c + 1, n->slot + n->cnt, n->slot + c);
+            n->cnt--;
+            return res;
+        }
+        Node* child = n->slot[c].child;
+        Block* res = remove(child, i);
+        n->slot[c] = summary(child);
+        if (child->cnt < min_fill && n->cnt > 1)
+            refill(n, c);
+        return res;
+    }
+    /**
+     * delete the blocks and the nodes below n
+     */
+    void clear(Node* n)
+    {
+        for (size_t i = 0; i < n->cnt; i++) {
+            if (n->leaf)
+                destroy(n->slot[i].blk);
+            else
+                clear(n->slot[i].child);
+        }
+        allocator_delete(alloc, n);
+        return;
+    }
+
+public:
+    /**
+     * constructors and destructors
+     * the blocks are owned by the tree
+     */
+    explicit block_tree(const Alloc& alloc = Alloc())
+        : root(nullptr)
+        , cnt(0)
+        , alloc(alloc)
+    {
+    }
+    block_tree(const block_tree& other)
+        : block_tree(other, other.alloc, false)
+    {
+    }
+    /**
+     * take the nodes of other, other is left with no blocks
+     */
+    block_tree(block_tree&& other) noexcept
+        : root(other.root)
+        , cnt(other.cnt)
+        , alloc(other.alloc)
+    {
+        other.root = nullptr;
+        other.cnt = 0;
+    }
+    /**
+     * copy the blocks of other with alloc, or share them if shared is set
+     * and alloc equals the allocator of other
+     */
+    block_tree(const block_tree& other, const Alloc& alloc, bool shared)
+        : block_tree(alloc)
+    {
+        try {
+            for (size_t i = 0; i < other.cnt; i++)
+                insert(cnt, shared ? share(other[i], other.alloc) : create(*other[i], alloc));
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+    ~block_tree()
+    {
+        clear();
+    }
+    block_tree& operator=(const block_tree& other)
+    {
+        if (this == &other)
+            return *this;
+        clear();
+        for (size_t i = 0; i < other.cnt; i++)
+            insert(cnt, create(*other[i], alloc));
+        return *this;
+    }
+    /**
+     * exchange the nodes with other, the allocators are exchanged
+     * if Propagate is std::true_type, otherwise they should be equal
+     */
+    template <class Propagate>
+    void swap(block_tree& other, Propagate) noexcept
+    {
+        std::swap(root, other.root);
+        std::swap(cnt, other.cnt);
+        swap_allocator(alloc, other.alloc, Propagate());
+        return;
+    }
+
+    /**
+     * create a block with the allocator of the tree
+     * args are passed to the constructor of the block
+     */
+    template <class... Args>
+    Block* create(Args&&... args) const
+    {
+        return allocator_new<Block>(alloc, std::forward<Args>(args)...);
+    }
+    /**
+     * take a reference to blk, owned by a directory using blk_alloc
+     * blocks are only shared between equal allocators, otherwise
+     * blk is copied
+     */
+    Block* share(Block* blk, const Alloc& blk_alloc) const
+    {
+        if (!(alloc == blk_alloc))
+            return create(*blk, alloc);
+        blk->acquire();
+        return blk;
+    }
+    /**
+     * drop a reference to blk, and delete it if it was the last one
+     */
+    void destroy(Block* blk) const
+    {
+        if (blk != nullptr && blk->release())
+            allocator_delete(alloc, blk);
+        return;
+    }
+    /**
+     * replace the i-th block by blk with the same size, and return
+     * the old one
+     */
+    Block* replace(size_t i, Block* blk)
+    {
+        Node* cur = root;
+        while (true) {
+            size_t c = 0;
+            while (i >= cur->slot[c].blocks)
+                i -= cur->slot[c++].blocks;
+            if (cur->leaf) {
+                Block* res = cur->slot[c].blk;
+                cur->slot[c].blk = blk;
+                return res;
+            }
+            cur = cur->slot[c].child;
+        }
+    }
+
+    /**
+     * the number of blocks
+     */
+    size_t size() const
+    {
+        return cnt;
+    }
+    bool empty() const
+    {
+        return cnt == 0;
+    }
+    /**
+     * the i-th block
+     */
+    Block* operator[](size_t i) const
+    {
+        Node* cur = root;
+        while (true) {
+            size_t c = 0;
+            while (i >= cur->slot[c].blocks)
+                i -= cur->slot[c++].blocks;
+            if (cur->leaf)
+                return cur->slot[c].blk;
+            cur = cur->slot[c].child;
+        }
+    }
+    /**
+     * the number of elements in front of the i-th block
+     */
+    size_t start(size_t i) const
+    {
+        size_t res = 0;
+        Node* cur = root;
+        while (true) {
+            size_t c = 0;
+            while (i >= cur->slot[c].blocks) {
+                i -= cur->slot[c].blocks;
+                res += cur->slot[c++].elems;
+            }
+            if (cur->leaf)
+                return res;
+            cur = cur->slot[c].child;
+        }
+    }
+    /**
+     * the last block whose start is not greater than index
+     */
+    size_t locate(size_t index) const
+    {
+        size_t res = 0;
+        Node* cur = root;
+        while (true) {
+            size_t c = 0;
+            while (c + 1 < cur->cnt && index >= cur->slot[c].elems) {
+                index -= cur->slot[c].elems;
+                res += cur->slot[c++].blocks;
+            }
+            if (cur->leaf)
+                return res;
+            cur = cur->slot[c].child;
+        }
+    }
+
+    /**
+     * delete all the blocks
+     */
+    void clear()
+    {
+        if (root != nullptr)
+            clear(root);
+        root = nullptr;
+        cnt = 0;
+        return;
+    }
+    /**
+     * the i-th block has gained delta elements (maybe negative)
+     * the counts on the path to it are updated
+     */
+    void adjust(size_t i, long long delta)
+    {
+        Node* cur = root;
+        while (true) {
+            size_t c = 0;
+            while (i >= cur->slot[c].blocks)
+                i -= cur->slot[c++].blocks;
+            cur->slot[c].elems += delta;
+            if (cur->leaf)
+                return;
+            cur = cur->slot[c].child;
+        }
+    }
+    /**
+     * delta elements have been moved from the (i + 1)-th block
+     * to the end of the i-th block
+     */
+    void transfer(size_t i, long long delta)
+    {
+        adjust(i, delta);
+        adjust(i + 1, -delta);
+        return;
+    }
+    /**
+     * insert blk so that it becomes the i-th block
+     */
+    void insert(size_t i, Block* blk)
+    {
+        if (root == nullptr)
+            root = allocator_new<Node>(alloc, true);
+        if (root->cnt == fanout) {
+            Node* top = allocator_new<Node>(alloc, false);
+            top->slot[0] = summary(root);
+            top->cnt = 1;
+            try {
+                split(top, 0);
+            } catch (...) {
+                allocator_delete(alloc, top);
+                throw;
+            }
+            root = top;
+        }
+        // the full nodes on the path are all split first, as a split may
+        // throw and the counts above it must not have been changed yet
+        Node* cur = root;
+        for (size_t j = i; !cur->leaf;) {
+            size_t c = 0;
+            while (c + 1 < cur->cnt && j > cur->slot[c].blocks)
+                j -= cur->slot[c++].blocks;
+            if (cur->slot[c].child->cnt == fanout) {
+                split(cur, c);
+                if (j > cur->slot[c].blocks)
+                    j -= cur->slot[c++].blocks;
+            }
+            cur = cur->slot[c].child;
+        }
+        size_t s = blk->size();
+        cur = root;
+        while (!cur->leaf) {
+            size_t c = 0;
+            while (c + 1 < cur->cnt && i > cur->slot[c].blocks)
+                i -= cur->slot[c++].blocks;
+            cur->slot[c].blocks++;
+            cur->slot[c].elems += s;
+            cur = cur->slot[c].child;
+        }
+        std::copy_backward(cur->slot + i, cur->slot + cur->cnt, cur->slot + cur->cnt + 1);
+        cur->slot[i] = Slot { nullptr, blk, 1, s };
+        cur->cnt++;
+        cnt++;
+        return;
+    }
+    /**
+     * erase and delete the i-th block
+     */
+    void erase(size_t i)
+    {
+        destroy(release(i));
+        return;
+    }
+    /**
+     * remove the i-th block and return it, without deleting it
+     */
+    Block* release(size_t i)
+    {
+        Block* res = remove(root, i);
+        cnt--;
+        if (!root->leaf && root->cnt == 1) {
+            Node* old = root;
+            root = root->slot[0].child;
+            allocator_delete(alloc, old);
+        }
+        if (cnt == 0)
+            clear();
+        return res;
+    }
+    /**
+     * erase and delete the blocks from first to last (not included)
+     */
+    void erase(size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; i++)
+            erase(first);
+        return;
+    }
+};
+/**
+ * the size in bytes of the L1 data cache (level 1) or the L2 cache
+ * (level 2) reported by the os, or a common size if it is unknown
+ */
+inline size_t cache_size(int level)
+{
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+    long res = sysconf(level == 1 ? _SC_LEVEL1_DCACHE_SIZE : _SC_LEVEL2_CACHE_SIZE);
+    if (res > 0)
+        return res;
+#endif
+    return level == 1 ? 32 * 1024 : 1024 * 1024;
+}
+/**
+ * the bytes of elements a block of deque holds at least (min_bytes),
+ * and at most after a rebuild (max_bytes)
+ * by default a block takes 1/8 of the L1 data cache, so shifting inside
+ * it stays cheap, and at most 1/4 of the L2 cache
+ */
+struct block_bytes {
+    size_t min_bytes, max_bytes;
+};
+inline block_bytes& block_bytes_config()
+{
+    static block_bytes conf = { cache_size(1) / 8, cache_size(2) / 4 };
+    return conf;
+}
+/**
+ * override the block sizes of the deques created or rebuilt afterwards
+ * 0 restores the detected size
+ * not synchronized, call it before using deques from other threads.
+ */
+inline void set_block_bytes(size_t min_bytes, size_t max_bytes = 0)
+{
+    block_bytes& conf = block_bytes_config();
+    conf.min_bytes = min_bytes ? min_bytes : cache_size(1) / 8;
+    conf.max_bytes = max_bytes ? max_bytes : cache_size(2) / 4;
+    return;
+}
+
+/**
+ * how a deque rebuilds its blocks to keep their length near sqrt(n)
+ * never:     keep the current length, blocks are only split and merged
+ * amortized: rebuild once every min(n, length^2) modifications
+ * threshold: rebuild when the length drifts more than factor times
+ *            away from sqrt(n)
+ * incremental: never rebuild, but split or merge a few blocks on each
+ *            modification, so every operation stays O(sqrt(n))
+ */
+enum class rebalance_policy {
+    never,
+    amortized,
+    threshold,
+    incremental
+};
+/**
+ * the directory deque keeps its blocks in
+ * array: a centered array, inserting or removing a block moves
+ *        O(number of blocks) entries, cheap while that is about sqrt(n)
+ * tree:  a B+ tree with the counts of its subtrees, every operation on
+ *        the directory is O(log(n)), and the blocks keep the minimal
+ *        length instead of growing to sqrt(n)
+ */
+enum class block_directory {
+    array,
+    tree
+};
+/**
+ * the compile-time layout policy of deque
+ * BlockCapacity: the length of every block, fixed at compile time
+ *                0 sizes the blocks at runtime from block_bytes
+ * GrowBlocks:    let a block start small and double its capacity up to
+ *                the block length, only used with runtime sizing
+ * Rebalance, Factor: the initial rebalance_policy and its factor
+ * CopyOnWrite:   a copy shares the blocks of the original, and a block
+ *                is copied when either side modifies it, so copying
+ *                costs O(number of blocks) instead of O(n)
+ * Directory:     the block_directory, tree suits deques of 10^7
+ *                elements and more
+ */
+template <size_t BlockCapacity = 0, bool GrowBlocks = true, rebalance_policy Rebalance = rebalance_policy::amortized, size_t Factor = 2, bool CopyOnWrite = false, block_directory Directory = block_directory::array>
+struct deque_policy {
+    static_assert(BlockCapacity != 1, "a block should hold at least 2 elements");
+    static constexpr size_t block_capacity = BlockCapacity;
+    static constexpr bool grow_blocks = GrowBlocks && BlockCapacity == 0;
+    static constexpr rebalance_policy rebalance = Rebalance;
+    static constexpr size_t rebalance_factor = Factor;
+    static constexpr bool copy_on_write = CopyOnWrite;
+    static constexpr block_directory directory = Directory;
+};
+template <class T, class Policy = deque_policy<>, class Allocator = std::allocator<T>>
+class deque {
+private:
+    using block_type = ring_buffer<T, Policy::block_capacity, Allocator>;
+    using map_type = typename std::conditional<Policy::directory == block_directory::tree, block_tree<block_type, Allocator>, block_map<block_type, Allocator>>::type;
+    using traits = std::allocator_traits<Allocator>;
+    Allocator alloc;
+    map_type block;
+    size_t length, sz;
+    /**
+     * the rebuild bookkeeping of this deque
+     */
+    rebalance_policy policy;
+    size_t factor, opts, last_construct, cursor;
+    /**
+     * an emptied block kept for reuse, so that pushing and popping
+     * around a block boundary doesn't allocate
+     */
+    block_type* spare;
+    /**
+     * whether some blocks may be shared with copies of this deque,
+     * under a copy-on-write policy
+     * only then a write checks the reference count of its block
+     */
+    mutable std::atomic<bool> sharing;
+    /**
+     * counts the modifications, the stamp of the iterators under
+     * SJTU_ITERATOR_CHECKS 2
+     */
+    size_t generation;
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using allocator_type = Allocator;
+
+    class const_iterator;
+    /**
+     * a random access iterator, a step inside a block is O(1), and a
+     * jump to another block looks it up in the directory
+     */
+    class iterator {
+        friend deque;
+
+    protected:
+        /**
+         * add data members.
+         * just add whatever you want.
+         */
+        mutable block_type* blk;
+        size_t bi, pos;
+        const deque* base;
+        size_t stamp;
+
+        /**
+         * whether the deque has been modified since the iterator was made
+         */
+        bool stale() const
+        {
+            return iterator_checks >= 2 && (base == nullptr || stamp != base->generation);
+        }
+
+        /**
+         * the block the iterator points into, looked up again under a
+         * copy-on-write policy, as a write through another iterator or
+         * detach() may have replaced it with a private copy (and the old
+         * one is freed with the last copy sharing it), and made private
+         * to the deque first for a write
+         */
+        block_type* current(bool write) const
+        {
+            if (Policy::copy_on_write && base != nullptr && bi < base->block.size())
+                blk = write ? const_cast<deque*>(base)->unshare(bi) : base->block[bi];
+            return blk;
+        }
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator()
+            : blk(nullptr)
+            , bi(0)
+            , pos(0)
+            , base(nullptr)
+            , stamp(0)
+        {
+        }
+        iterator(size_t bi, size_t pos, const deque* base)
+            : blk(bi < base->block.size() ? base->block[bi] : nullptr)
+            , bi(bi)
+            , pos(pos)
+            , base(base)
+            , stamp(base->generation)
+        {
+        }
+        ~iterator() = default;
+        iterator(const iterator& other)
+            : blk(other.blk)
+            , bi(other.bi)
+            , pos(other.pos)
+            , base(other.base)
+            , stamp(other.stamp)
+        {
+        }
+        iterator& operator=(const iterator& other)
+        {
+            blk = other.blk;
+            bi = other.bi;
+            pos = other.pos;
+            base = other.base;
+            stamp = other.stamp;
+            return *this;
+        }
+
+        /**
+         * return a new iterator which points to the n-next element.
+         * if there are not enough elements, the behaviour is undefined.
+         * same for operator-.
+         */
+        iterator operator+(difference_type n) const
+        {
+            if (n < 0)
+                return *this - (-n);
+            if (iterator_checks >= 1 && stale())
+                throw invalid_iterator();
+            block_type* cur = current(false);
+            if (cur != nullptr && pos + n < cur->size()) {
+                iterator res(*this);
+                res.pos += n;
+                return res;
+            }
+            size_t index = base->index_of(*this) + n;
+            if (iterator_checks >= 1 && index > base->sz)
+                throw invalid_iterator();
+            return base->locate(index);
+        }
+        iterator operator-(difference_type n) const
+        {
+            if (n < 0)
+                return *this + (-n);
+            if (iterator_checks >= 1 && stale())
+                throw invalid_iterator();
+            if ((size_t)n <= pos) {
+                iterator res(*this);
+                res.pos -= n;
+                return res;
+            }
+            size_t index = base->index_of(*this);
+            if (iterator_checks >= 1 && (size_t)n > index)
+                throw invalid_iterator();
+            return base->locate(index - n);
+        }
+        friend iterator operator+(difference_type n, const iterator& it)
+        {
+            return it + n;
+        }
+
+        /**
+         * return the distance between two iterators.
+         * if they point to different vectors, throw
+         * invaild_iterator.
+         */
+        difference_type operator-(const iterator& rhs) const
+        {
+            if (base != rhs.base || stale() || rhs.stale())
+                throw invalid_iterator();
+            if (bi == rhs.bi)
+                return (difference_type)pos - (difference_type)rhs.pos;
+            return (difference_type)base->index_of(*this) - (difference_type)base->index_of(rhs);
+        }
+        iterator& operator+=(difference_type n)
+        {
+            iterator temp = (*this) + n;
+            *this = temp;
+            return *this;
+        }
+        iterator& operator-=(difference_type n)
+        {
+            iterator temp = (*this) - n;
+            *this = temp;
+            return *this;
+        }
+
+        /**
+         * iter++
+         */
+        iterator operator++(int)
+        {
+            iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+        /**
+         * ++iter
+         */
+        iterator& operator++()
+        {
+            block_type* cur = current(false);
+            if (iterator_checks >= 1 && (stale() || cur == nullptr || pos >= cur->size()))
+                throw invalid_iterator();
+            if (pos + 1 == cur->size() && bi + 1 < base->block.size()) {
+                blk = base->block[++bi];
+                pos = 0;
+            } else
+                pos++;
+            return *this;
+        }
+        /**
+         * iter--
+         */
+        iterator operator--(int)
+        {
+            iterator temp = *this;
+            --(*this);
+            return temp;
+        }
+        /**
+         * --iter
+         */
+        iterator& operator--()
+        {
+            if (iterator_checks >= 1 && (stale() || current(false) == nullptr || (pos == 0 && bi == 0)))
+                throw invalid_iterator();
+            if (pos == 0) {
+                blk = base->block[--bi];
+                pos = blk->size() - 1;
+            } else
+                pos--;
+            return *this;
+        }
+
+        T* get() const
+        {
+            block_type* cur = current(true);
+            if (iterator_checks >= 1 && (stale() || cur == nullptr || pos >= cur->size()))
+                throw invalid_iterator();
+            return &(*cur)[pos];
+        }
+        /**
+         * *it
+         */
+        T& operator*() const
+        {
+            return *get();
+        }
+        /**
+         * it->field
+         */
+        T* operator->() const noexcept(iterator_checks == 0)
+        {
+            return get();
+        }
+        T& operator[](difference_type n) const
+        {
+            return *(*this + n);
+        }
+
+        /**
+         * check whether two iterators are the same (pointing to the same
+         * memory).
+         */
+        bool operator==(const iterator& rhs) const
+        {
+            return bi == rhs.bi && pos == rhs.pos && base == rhs.base;
+        }
+        bool operator==(const const_iterator& rhs) const
+        {
+            return bi == rhs.bi && pos == rhs.pos && base == rhs.base;
+        }
+        /**
+         * some other operator for iterators.
+         */
+        bool operator!=(const iterator& rhs) const
+        {
+            return bi != rhs.bi || pos != rhs.pos || base != rhs.base;
+        }
+        bool operator!=(const const_iterator& rhs) const
+        {
+            return bi != rhs.bi || pos != rhs.pos || base != rhs.base;
+        }
+        /**
+         * the order of the elements, for iterators of the same deque
+         * (including const_iterator)
+         */
+        bool operator<(const iterator& rhs) const
+        {
+            return bi < rhs.bi || (bi == rhs.bi && pos < rhs.pos);
+        }
+        bool operator>(const iterator& rhs) const
+        {
+            return rhs < *this;
+        }
+        bool operator<=(const iterator& rhs) const
+        {
+            return !(rhs < *this);
+        }
+        bool operator>=(const iterator& rhs) const
+        {
+            return !(*this < rhs);
+        }
+    };
+
+    class const_iterator : public iterator {
+        friend deque;
+
+    public:
+        const_iterator() = default;
+        const_iterator(const iterator& t)
+            : iterator(t)
+        {
+        }
+        const_iterator(size_t bi, size_t pos, const deque* base)
+            : iterator(bi, pos, base)
+        {
+        }
+        ~const_iterator() = default;
+        using pointer = const T*;
+        using reference = const T&;
+
+        /**
+         * the arithmetic of iterator, returning const_iterator
+         */
+        const_iterator operator+(difference_type n) const
+        {
+            return iterator::operator+(n);
+        }
+        const_iterator operator-(difference_type n) const
+        {
+            return iterator::operator-(n);
+        }
+        difference_type operator-(const iterator& rhs) const
+        {
+            return iterator::operator-(rhs);
+        }
+        friend const_iterator operator+(difference_type n, const const_iterator& it)
+        {
+            return it + n;
+        }
+        const_iterator& operator+=(difference_type n)
+        {
+            iterator::operator+=(n);
+            return *this;
+        }
+        const_iterator& operator-=(difference_type n)
+        {
+            iterator::operator-=(n);
+            return *this;
+        }
+        const_iterator& operator++()
+        {
+            iterator::operator++();
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator temp = *this;
+            iterator::operator++();
+            return temp;
+        }
+        const_iterator& operator--()
+        {
+            iterator::operator--();
+            return *this;
+        }
+        const_iterator operator--(int)
+        {
+            const_iterator temp = *this;
+            iterator::operator--();
+            return temp;
+        }
+        const T* get() const
+        {
+            block_type* cur = iterator::current(false);
+            if (iterator_checks >= 1 && (this->stale() || cur == nullptr || this->pos >= cur->size()))
+                throw invalid_iterator();
+            return &(*cur)[this->pos];
+        }
+        const T& operator*() const
+        {
+            return *get();
+        }
+        const T* operator->() const noexcept(iterator_checks == 0)
+        {
+            return get();
+        }
+        const T& operator[](difference_type n) const
+        {
+            return *(*this + n);
+        }
+    };
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    /**
+     * constructors.
+     */
+    deque()
+        : deque(Allocator())
+    {
+    }
+    /**
+     * an empty deque owns no blocks, the first one is created
+     * by the first insertion
+     */
+    explicit deque(const Allocator& alloc)
+        : alloc(alloc)
+        , block(alloc)
+    {
+        length = min_length();
+        sz = 0;
+        policy = Policy::rebalance;
+        factor = Policy::rebalance_factor;
+        opts = last_construct = cursor = 0;
+        spare = nullptr;
+        sharing = false;
+        generation = 0;
+    }
+    /**
+     * under a copy-on-write policy the copy shares the blocks of other,
+     * and a block is copied when either side modifies it
+     */
+    deque(const deque& other)
+        : alloc(traits::select_on_container_copy_construction(other.alloc))
+        , block(other.block, alloc, Policy::copy_on_write)
+    {
+        length = other.length;
+        sz = other.sz;
+        policy = other.policy;
+        factor = other.factor;
+        opts = last_construct = cursor = 0;
+        spare = nullptr;
+        generation = 0;
+        sharing = Policy::copy_on_write && alloc == other.alloc && !block.empty();
+        if (sharing)
+            other.sharing = true;
+    }
+    /**
+     * take the blocks of other in O(1), other is left empty
+     */
+    deque(deque&& other) noexcept
+        : alloc(other.alloc)
+        , block(std::move(other.block))
+    {
+        length = other.length;
+        sz = other.sz;
+        policy = other.policy;
+        factor = other.factor;
+        opts = other.opts;
+        last_construct = other.last_construct;
+        cursor = other.cursor;
+        spare = other.spare;
+        sharing = other.sharing.load();
+        other.sz = 0;
+        other.opts = other.last_construct = other.cursor = 0;
+        other.spare = nullptr;
+        other.sharing = false;
+        generation = 0;
+        other.generation++;
+    }
+
+    /**
+     * deconstructor.
+     */
+    ~deque()
+    {
+        block.destroy(spare);
+        length = 0;
+        sz = 0;
+    }
+
+    /**
+     * assignment operator.
+     * the blocks of other are shared as in the copy constructor, and
+     * the allocator of other is taken if it propagates on copy assignment
+     */
+    deque& operator=(const deque& other)
+    {
+        if (this == &other)
+            return *this;
+        using propagate = typename traits::propagate_on_container_copy_assignment;
+        const Allocator& new_alloc = propagate::value ? other.alloc : alloc;
+        map_type temp(other.block, new_alloc, Policy::copy_on_write);
+        block.destroy(spare);
+        spare = nullptr;
+        block.swap(temp, propagate());
+        propagate_allocator(alloc, other.alloc, propagate());
+        generation++;
+        sharing = Policy::copy_on_write && alloc == other.alloc && !block.empty();
+        if (sharing)
+            other.sharing = true;
+        length = other.length;
+        sz = other.sz;
+        policy = other.policy;
+        factor = other.factor;
+        opts = last_construct = cursor = 0;
+        return *this;
+    }
+    /**
+     * take the blocks of other in O(1) if the allocator propagates on
+     * move assignment or both allocators are equal, otherwise move the
+     * elements one by one
+     */
+    deque& operator=(deque&& other) noexcept(traits::propagate_on_container_move_assignment::value || traits::is_always_equal::value)
+    {
+        if (this == &other)
+            return *this;
+        using propagate = typename traits::propagate_on_container_move_assignment;
+        if (!propagate::value && alloc != other.alloc) {
+            clear();
+            for (size_t i = 0; i < other.block.size(); i++) {
+                block_type* cur = other.block[i];
+                for (size_t j = 0; j < cur->size(); j++)
+                    emplace(end(), std::move((*cur)[j]));
+            }
+            other.clear();
+            return *this;
+        }
+        map_type temp(std::move(other.block));
+        block.destroy(spare);
+        block.swap(temp, propagate());
+        propagate_allocator(alloc, other.alloc, propagate());
+        length = other.length;
+        sz = other.sz;
+        policy = other.policy;
+        factor = other.factor;
+        opts = other.opts;
+        last_construct = other.last_construct;
+        cursor = other.cursor;
+        spare = other.spare;
+        sharing = other.sharing.load();
+        other.sz = 0;
+        other.opts = other.last_construct = other.cursor = 0;
+        other.spare = nullptr;
+        other.sharing = false;
+        generation++;
+        other.generation++;
+        return *this;
+    }
+    /**
+     * exchange the contents of two deques in O(1)
+     * the allocators are exchanged if they propagate on swap, otherwise
+     * they should be equal
+     */
+    void swap(deque& other) noexcept
+    {
+        using propagate = typename traits::propagate_on_container_swap;
+        block.swap(other.block, propagate());
+        swap_allocator(alloc, other.alloc, propagate());
+        std::swap(length, other.length);
+        std::swap(sz, other.sz);
+        std::swap(policy, other.policy);
+        std::swap(factor, other.factor);
+        std::swap(opts, other.opts);
+        std::swap(last_construct, other.last_construct);
+        std::swap(cursor, other.cursor);
+        std::swap(spare, other.spare);
+        sharing = other.sharing.exchange(sharing.load());
+        generation++;
+        other.generation++;
+        return;
+    }
+
+    /**
+     * access a specified element with bound checking.
+     * throw index_out_of_bound if out of bound.
+     */
+    T& at(const int& pos)
+    {
+        if (pos < 0 || (size_t)pos >= sz)
+            throw index_out_of_bound();
+        size_t i = block.locate(pos);
+        return (*unshare(i))[pos - block.start(i)];
+    }
+    const T& at(const int& pos) const
+    {
+        if (pos < 0 || (size_t)pos >= sz)
+            throw index_out_of_bound();
+        size_t i = block.locate(pos);
+        return (*block[i])[pos - block.start(i)];
+    }
+    T& operator[](const int& pos)
+    {
+        return at(pos);
+    }
+    const T& operator[](const int& pos) const
+    {
+        return at(pos);
+    }
+    /**
+     * the longest run of elements from the index-th one that is
+     * contiguous in memory, as [first, last)
+     * a loop over the runs touches the directory once per run instead
+     * of checking the block boundary at every element.
+     * throw index_out_of_bound if index >= size().
+     */
+    std::pair<T*, T*> segment(size_t index)
+    {
+        if (index >= sz)
+            throw index_out_of_bound();
+        size_t i = block.locate(index), pos = index - block.start(i);
+        block_type* cur = unshare(i);
+        T* first = &(*cur)[pos];
+        return std::make_pair(first, first + cur->contiguous(pos));
+    }
+    std::pair<const T*, const T*> segment(size_t index) const
+    {
+        if (index >= sz)
+            throw index_out_of_bound();
+        size_t i = block.locate(index), pos = index - block.start(i);
+        const block_type* cur = block[i];
+        const T* first = &(*cur)[pos];
+        return std::make_pair(first, first + cur->contiguous(pos));
+    }
+    /**
+     * make every block private to this deque under a copy-on-write
+     * policy, so that writing through the segments of disjoint ranges
+     * copies no block and may run on several threads at once
+     */
+    void detach()
+    {
+        if (!Policy::copy_on_write || !sharing.load())
+            return;
+        for (size_t i = 0; i < block.size(); i++)
+            unshare(i);
+        sharing = false;
+        return;
+    }
+
+    /**
+     * access the first element.
+     * throw container_is_empty when the container is empty.
+     */
+    const T& front() const
+    {
+        if (empty())
+            throw container_is_empty();
+        return *cbegin();
+    }
+    /**
+     * access the last element.
+     * throw container_is_empty when the container is empty.
+     */
+    const T& back() const
+    {
+        if (empty())
+            throw container_is_empty();
+        return *clast();
+    }
+
+    /**
+     * return an iterator to the beginning.
+     */
+    iterator begin()
+    {
+        return iterator(0, 0, this);
+    }
+    const_iterator cbegin() const
+    {
+        return const_iterator(0, 0, this);
+    }
+    const_iterator begin() const
+    {
+        return cbegin();
+    }
+
+    /**
+     * return an iterator to the last element
+     */
+    iterator last()
+    {
+        size_t i = block.size() - 1;
+        return iterator(i, block[i]->size() - 1, this);
+    }
+    const_iterator clast() const
+    {
+        size_t i = block.size() - 1;
+        return const_iterator(i, block[i]->size() - 1, this);
+    }
+
+    /**
+     * return an iterator to the end.
+     */
+    iterator end()
+    {
+        if (block.empty())
+            return iterator(0, 0, this);
+        size_t i = block.size() - 1;
+        return iterator(i, block[i]->size(), this);
+    }
+    const_iterator cend() const
+    {
+        if (block.empty())
+            return const_iterator(0, 0, this);
+        size_t i = block.size() - 1;
+        return const_iterator(i, block[i]->size(), this);
+    }
+    const_iterator end() const
+    {
+        return cend();
+    }
+
+    /**
+     * the reverse iterators, from the last element to the first one
+     */
+    reverse_iterator rbegin()
+    {
+        return reverse_iterator(end());
+    }
+    const_reverse_iterator rbegin() const
+    {
+        return crbegin();
+    }
+    const_reverse_iterator crbegin() const
+    {
+        return const_reverse_iterator(cend());
+    }
+    reverse_iterator rend()
+    {
+        return reverse_iterator(begin());
+    }
+    const_reverse_iterator rend() const
+    {
+        return crend();
+    }
+    const_reverse_iterator crend() const
+    {
+        return const_reverse_iterator(cbegin());
+    }
+
+    /**
+     * check whether the container is empty.
+     */
+    bool empty() const
+    {
+        return sz == 0;
+    }
+
+    /**
+     * return the number of elements.
+     */
+    size_t size() const
+    {
+        return sz;
+    }
+
+    /**
+     * clear all contents.
+     */
+    void clear()
+    {
+        block.clear();
+        length = min_length();
+        sz = 0;
+        opts = last_construct = cursor = 0;
+        sharing = false;
+        generation++;
+    }
+
+    Allocator get_allocator() const
+    {
+        return alloc;
+    }
+
+    /**
+     * change how this deque rebuilds its blocks
+     * factor is only used by rebalance_policy::threshold, and should be
+     * greater than 1.
+     */
+    void set_rebalance_policy(rebalance_policy new_policy, size_t new_factor = 2)
+    {
+        if (new_factor < 2)
+            new_factor = 2;
+        policy = new_policy;
+        factor = new_factor;
+        last_construct = opts;
+        return;
+    }
+    rebalance_policy get_rebalance_policy() const
+    {
+        return policy;
+    }
+
+    /**
+     * return the index of the element pointed by pos, in O(1)
+     * throw invalid_iterator if pos doesn't belong to this deque.
+     */
+    size_t index_of(const iterator& pos) const
+    {
+        if (pos.base != this)
+            throw invalid_iterator();
+        if (block.empty())
+            return 0;
+        return block.start(pos.bi) + pos.pos;
+    }
+    /**
+     * the bounds of the block length, from the byte sizes in block_bytes
+     * or the fixed capacity of the policy
+     */
+    static size_t min_length()
+    {
+        if (Policy::block_capacity != 0)
+            return Policy::block_capacity;
+        return std::max(block_bytes_config().min_bytes / sizeof(T), (size_t)16);
+    }
+    static size_t max_length()
+    {
+        if (Policy::block_capacity != 0)
+            return Policy::block_capacity;
+        return std::max(block_bytes_config().max_bytes / sizeof(T), min_length());
+    }
+    /**
+     * the current block length, a constant under a fixed capacity
+     */
+    size_t block_length() const
+    {
+        return Policy::block_capacity != 0 ? Policy::block_capacity : length;
+    }
+    /**
+     * the block length a rebuild aims at: sqrt(n), within the bounds
+     * the minimal length under a tree directory
+     */
+    size_t target_length() const
+    {
+        if (Policy::directory == block_directory::tree)
+            return min_length();
+        size_t res = std::sqrt(size()) + 1;
+        return std::min(std::max(res, min_length()), max_length());
+    }
+    /**
+     * make room in the block at pos if it is full
+     * a block shorter than length doubles its capacity, otherwise
+     * the half after the middle is moved into a new block
+     */
+    iterator split(iterator pos)
+    {
+        pos.blk = unshare(pos.bi);
+        if (!pos.blk->full())
+            return pos;
+        if (Policy::grow_blocks && pos.blk->capacity() < length) {
+            pos.blk->reserve(std::min(pos.blk->capacity() * 2, length));
+            return pos;
+        }
+        size_t half = pos.blk->size() / 2;
+        split_block(pos.bi, half);
+        if (pos.pos <= half)
+            return iterator(pos.bi, pos.pos, this);
+        return iterator(pos.bi + 1, pos.pos - half, this);
+    }
+    /**
+     * merge the block at pos and the block at pos + 1
+     */
+    iterator merge(iterator pos)
+    {
+        if (pos.bi + 1 < block.size() && pos.blk->size() + block[pos.bi + 1]->size() <= block_length()) {
+            merge_block(pos.bi);
+            return iterator(pos.bi, pos.pos, this);
+        }
+        if (pos.bi != 0 && pos.blk->size() + block[pos.bi - 1]->size() <= block_length()) {
+            size_t old_pos = block[pos.bi - 1]->size() + pos.pos;
+            merge_block(pos.bi - 1);
+            return iterator(pos.bi - 1, old_pos, this);
+        }
+        return pos;
+    }
+    /**
+     * reconstruct the block
+     */
+    iterator reconstruct(iterator pos)
+    {
+        opts++;
+        if (policy == rebalance_policy::incremental)
+            return rebalance(pos);
+        if (!need_reconstruct())
+            return pos;
+        length = target_length();
+        last_construct = opts;
+        size_t new_pos = index_of(pos);
+        map_type map(alloc);
+        block_type* cur = map.create(length, alloc);
+        for (size_t i = 0; i < block.size(); i++) {
+            block_type* temp = block[i];
+            bool own = !temp->shared();
+            for (size_t j = 0; j < temp->size(); j++) {
+                if (cur->full()) {
+                    map.insert(map.size(), cur);
+                    cur = map.create(length, alloc);
+                }
+                take(cur, (*temp)[j], own, std::integral_constant<bool, Policy::copy_on_write>());
+            }
+            if (own)
+                temp->clear();
+        }
+        map.insert(map.size(), cur);
+        block.swap(map, std::false_type());
+        sharing = false;
+        return locate(new_pos);
+    }
+
+    /**
+     * insert value before pos.
+     * return an iterator pointing to the inserted value.
+     * throw if the iterator is invalid or it points to a wrong place.
+     */
+    iterator insert(iterator pos, const T& value)
+    {
+        return emplace(pos, value);
+    }
+    iterator insert(iterator pos, T&& value)
+    {
+        return emplace(pos, std::move(value));
+    }
+    /**
+     * insert the elements of [first, last) before pos.
+     * return an iterator pointing to the first inserted element, or pos
+     * if the range is empty.
+     * throw if the iterator is invalid or it points to a wrong place.
+     */
+    template <class InputIt, class = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+    iterator insert(iterator pos, InputIt first, InputIt last)
+    {
+        return insert_blocks(pos, [&](block_type* cur) {
+            if (first == last)
+                return false;
+            cur->emplace_tail(*first);
+            ++first;
+            return true;
+        });
+    }
+    /**
+     * insert n copies of value before pos.
+     * return an iterator pointing to the first inserted element, or pos
+     * if n is 0.
+     */
+    iterator insert(iterator pos, size_t n, const T& value)
+    {
+        T temp(value);
+        return insert_blocks(pos, [&](block_type* cur) {
+            if (n == 0)
+                return false;
+            cur->insert_tail(temp);
+            n--;
+            return true;
+        });
+    }
+    /**
+     * construct an element from args before pos, in its final slot.
+     * return an iterator pointing to the new element.
+     * if the block at pos has to be split, the element is built first,
+     * since args may refer to an element the split moves.
+     */
+    template <class... Args>
+    iterator emplace(iterator pos, Args&&... args)
+    {
+        if (pos.base != this || pos.stale())
+            throw invalid_iterator();
+        if (block.empty()) {
+            block_type* cur = new_block(Policy::grow_blocks ? std::min(length, (size_t)16) : length);
+            try {
+                block.insert(0, cur);
+            } catch (...) {
+                free_block(cur);
+                throw;
+            }
+            pos = begin();
         }
-        const T& operator*() const
-        {
-            if (*this == this->base->cend())
-                throw invalid_iterator();
-            return *this->list_it;
+        if (pos.bi >= block.size() || pos.pos > block[pos.bi]->size())
+            throw invalid_iterator();
+        touch(pos);
+        pos.blk = unshare(pos.bi);
+        if (pos.blk->full()) {
+            T temp(std::forward<Args>(args)...);
+            pos = split(pos);
+            pos.blk->emplace(pos.pos, std::move(temp));
+        } else
+            pos.blk->emplace(pos.pos, std::forward<Args>(args)...);
+        block.adjust(pos.bi, 1);
+        sz++;
+        pos = reconstruct(pos);
+        return pos;
+    }
+
+    /**
+     * remove the element at pos.
+     * return an iterator pointing to the following element. if pos points to
+     * the last element, return end(). throw if the container is empty,
+     * the iterator is invalid, or it points to a wrong place.
+     */
+    iterator erase(iterator pos)
+    {
+        if (pos.base != this || pos.stale() || pos.bi >= block.size() || pos.pos >= block[pos.bi]->size())
+            throw invalid_iterator();
+        touch(pos);
+        pos.blk = unshare(pos.bi);
+        sz--;
+        pos.blk->erase(pos.pos);
+        block.adjust(pos.bi, -1);
+        if (pos.pos == pos.blk->size()) {
+            if (pos.bi + 1 == block.size()) {
+                if (pos.blk->empty() && block.size() != 1)
+                    free_block(block.release(pos.bi));
+                return end();
+            }
+            if (pos.blk->empty())
+                free_block(block.release(pos.bi));
+            else
+                pos.bi++;
+            pos = iterator(pos.bi, 0, this);
         }
-        const T* operator->() const noexcept
-        {
-            if (*this == this->base->cend())
-                throw invalid_iterator();
-            return this->list_it.get();
+        pos = merge(pos);
+        pos = reconstruct(pos);
+        return pos;
+    }
+    /**
+     * remove the elements in [first, last).
+     * return an iterator pointing to the element following them.
+     * throw if the iterators are invalid or first is after last.
+     * the blocks inside the range are dropped as a whole, and only the
+     * two blocks at the ends are shifted.
+     */
+    iterator erase(iterator first, iterator last)
+    {
+        if (first.base != this || last.base != this || first.stale() || last.stale())
+            throw invalid_iterator();
+        if (!block.empty() && (first.bi >= block.size() || first.pos > block[first.bi]->size() || last.bi >= block.size() || last.pos > block[last.bi]->size()))
+            throw invalid_iterator();
+        size_t a = index_of(first), b = index_of(last);
+        if (a > b)
+            throw invalid_iterator();
+        if (a == b)
+            return locate(a);
+        touch();
+        size_t i = first.bi, j = last.bi;
+        if (i == j) {
+            unshare(i)->erase(first.pos, b - a);
+            block.adjust(i, -(long long)(b - a));
+        } else {
+            block_type* cur = unshare(i);
+            size_t d = cur->size() - first.pos;
+            cur->erase(first.pos, d);
+            block.adjust(i, -(long long)d);
+            if (last.pos != 0) {
+                unshare(j)->erase(0, last.pos);
+                block.adjust(j, -(long long)last.pos);
+            }
+            block.erase(i + 1, j);
+            if (block[i + 1]->empty())
+                free_block(block.release(i + 1));
         }
-    };
+        sz -= b - a;
+        if (block[i]->empty())
+            free_block(block.release(i));
+        if (block.empty())
+            return end();
+        iterator pos = merge(locate(a));
+        return reconstruct(pos);
+    }
 
     /**
-     * constructors.
+     * add an element to the end.
      */
-    deque()
+    void push_back(const T& value)
     {
-        block = new double_list<double_list<T>>();
-        block->insert_tail(double_list<T>());
-        length = 200;
-        sz = 0;
+        emplace_end(true, value);
+        return;
     }
-    deque(const deque& other)
+    void push_back(T&& value)
     {
-        block = new double_list<double_list<T>>(*other.block);
-        length = other.length;
-        sz = other.sz;
+        emplace_end(true, std::move(value));
+        return;
     }
-
     /**
-     * deconstructor.
+     * construct an element from args at the end, and return it.
      */
-    ~deque()
+    template <class... Args>
+    T& emplace_back(Args&&... args)
     {
-        delete block;
-        length = 200;
-        sz = 0;
+        return emplace_end(true, std::forward<Args>(args)...);
     }
 
     /**
-     * assignment operator.
+     * remove the last element.
+     * throw when the container is empty.
      */
-    deque& operator=(const deque& other)
+    void pop_back()
     {
-        if (this == &other)
-            return *this;
-        delete block;
-        block = new double_list<double_list<T>>(*other.block);
-        length = other.length;
-        sz = other.sz;
-        return *this;
+        pop_end(true);
+        return;
     }
 
     /**
-     * access a specified element with bound checking.
-     * throw index_out_of_bound if out of bound.
+     * insert an element to the beginning.
      */
-    T& at(const int& pos)
+    void push_front(const T& value)
     {
-        return *(begin() + pos);
+        emplace_end(false, value);
+        return;
     }
-    const T& at(const int& pos) const
+    void push_front(T&& value)
     {
-        return *(cbegin() + pos);
+        emplace_end(false, std::move(value));
+        return;
     }
-    T& operator[](const int& pos)
+    /**
+     * construct an element from args at the beginning, and return it.
+     */
+    template <class... Args>
+    T& emplace_front(Args&&... args)
     {
-        return at(pos);
+        return emplace_end(false, std::forward<Args>(args)...);
     }
-    const T& operator[](const int& pos) const
+
+    /**
+     * remove the first element.
+     * throw when the container is empty.
+     */
+    void pop_front()
     {
-        return at(pos);
+        pop_end(false);
+        return;
     }
 
     /**
-     * access the first element.
-     * throw container_is_empty when the container is empty.
+     * the non-throwing accessors, a null pointer or false tells that
+     * the index is out of bound or the container is empty
      */
-    const T& front() const
+    T* try_at(size_t pos)
+    {
+        if (pos >= sz)
+            return nullptr;
+        size_t i = block.locate(pos);
+        return &(*unshare(i))[pos - block.start(i)];
+    }
+    const T* try_at(size_t pos) const
+    {
+        if (pos >= sz)
+            return nullptr;
+        size_t i = block.locate(pos);
+        return &(*block[i])[pos - block.start(i)];
+    }
+    T* try_front()
+    {
+        return empty() ? nullptr : &(*unshare(0))[0];
+    }
+    const T* try_front() const
+    {
+        return empty() ? nullptr : &(*block[0])[0];
+    }
+    T* try_back()
     {
         if (empty())
-            throw container_is_empty();
-        return *cbegin();
+            return nullptr;
+        block_type* cur = unshare(block.size() - 1);
+        return &(*cur)[cur->size() - 1];
+    }
+    const T* try_back() const
+    {
+        if (empty())
+            return nullptr;
+        block_type* cur = block[block.size() - 1];
+        return &(*cur)[cur->size() - 1];
+    }
+    bool try_pop_back()
+    {
+        if (empty())
+            return false;
+        pop_end(true);
+        return true;
+    }
+    bool try_pop_front()
+    {
+        if (empty())
+            return false;
+        pop_end(false);
+        return true;
     }
     /**
-     * access the last element.
-     * throw container_is_empty when the container is empty.
+     * move the removed element into out
      */
-    const T& back() const
+    bool try_pop_back(T& out)
     {
-        if (empty())
-            throw container_is_empty();
-        return *clast();
+        T* cur = try_back();
+        if (cur == nullptr)
+            return false;
+        out = std::move(*cur);
+        pop_end(true);
+        return true;
+    }
+    bool try_pop_front(T& out)
+    {
+        T* cur = try_front();
+        if (cur == nullptr)
+            return false;
+        out = std::move(*cur);
+        pop_end(false);
+        return true;
     }
 
     /**
-     * return an iterator to the beginning.
+     * move all the elements of other to the end, other is left empty.
+     * the blocks of other are relinked in O(sqrt(n)), unless the
+     * allocators differ and the elements are moved one by one.
+     * iterators of other are invalidated.
      */
-    iterator begin()
+    void splice_back(deque&& other)
     {
-        return iterator(block->begin(), block->begin()->begin(), this);
+        if (this == &other || other.empty())
+            return;
+        touch();
+        other.touch();
+        if (alloc != other.alloc) {
+            for (size_t i = 0; i < other.block.size(); i++) {
+                block_type* cur = other.block[i];
+                for (size_t j = 0; j < cur->size(); j++)
+                    emplace(end(), std::move((*cur)[j]));
+            }
+            other.clear();
+            return;
+        }
+        if (sz == 0)
+            clear();
+        size_t seam = block.size();
+        while (!other.block.empty()) {
+            block_type* cur = other.block.release(0);
+            sz += cur->size();
+            block.insert(block.size(), cur);
+        }
+        absorb(other);
+        if (seam != 0 && block[seam - 1]->size() + block[seam]->size() <= block_length())
+            merge_block(seam - 1);
+        return;
     }
-    const_iterator cbegin() const
+    /**
+     * move all the elements of other to the beginning, other is left empty.
+     */
+    void splice_front(deque&& other)
+    {
+        if (this == &other || other.empty())
+            return;
+        touch();
+        other.touch();
+        if (alloc != other.alloc) {
+            iterator pos = begin();
+            for (size_t i = 0; i < other.block.size(); i++) {
+                block_type* cur = other.block[i];
+                for (size_t j = 0; j < cur->size(); j++)
+                    pos = ++emplace(pos, std::move((*cur)[j]));
+            }
+            other.clear();
+            return;
+        }
+        if (sz == 0)
+            clear();
+        size_t seam = other.block.size();
+        while (!other.block.empty()) {
+            block_type* cur = other.block.release(other.block.size() - 1);
+            sz += cur->size();
+            block.insert(0, cur);
+        }
+        absorb(other);
+        if (seam < block.size() && block[seam - 1]->size() + block[seam]->size() <= block_length())
+            merge_block(seam - 1);
+        return;
+    }
+    /**
+     * remove the elements from index to the end, and return them
+     * as a new deque.
+     * the block at index is split in two and the blocks after it are
+     * relinked, so it costs O(sqrt(n)).
+     * throw index_out_of_bound if index is greater than size().
+     */
+    deque split_at(size_t index)
     {
-        return const_iterator(block->begin(), block->begin()->begin(), this);
+        if (index > sz)
+            throw index_out_of_bound();
+        deque res(alloc);
+        res.length = length;
+        res.policy = policy;
+        res.factor = factor;
+        if (index == sz)
+            return res;
+        touch();
+        size_t first = cut(index);
+        while (block.size() > first) {
+            block_type* cur = block.release(block.size() - 1);
+            sz -= cur->size();
+            res.sz += cur->size();
+            res.block.insert(0, cur);
+        }
+        res.sharing = sharing.load();
+        if (sz == 0)
+            clear();
+        return res;
+    }
+    /**
+     * remove the first index elements, and return them as a new deque.
+     * throw index_out_of_bound if index is greater than size().
+     */
+    deque split_front(size_t index)
+    {
+        if (index > sz)
+            throw index_out_of_bound();
+        deque res(alloc);
+        res.length = length;
+        res.policy = policy;
+        res.factor = factor;
+        if (index == 0)
+            return res;
+        touch();
+        size_t first = cut(index);
+        for (size_t i = 0; i < first; i++) {
+            block_type* cur = block.release(0);
+            sz -= cur->size();
+            res.sz += cur->size();
+            res.block.insert(res.block.size(), cur);
+        }
+        res.sharing = sharing.load();
+        if (sz == 0)
+            clear();
+        return res;
     }
 
+private:
     /**
-     * return an iterator to the last element
+     * start a new generation of the iterators, pos is moved to it
      */
-    iterator last()
+    void touch()
     {
-        return iterator(block->last(), block->last()->last(), this);
+        generation++;
+        return;
     }
-    const_iterator clast() const
+    void touch(iterator& pos)
     {
-        return const_iterator(block->last(), block->last()->last(), this);
+        pos.stamp = ++generation;
+        return;
     }
-
     /**
-     * return an iterator to the end.
+     * return an iterator to the index-th element, index may be size()
+     * const for the iterators, which hold a const deque*, so it is
+     * kept private, as the iterator it returns can write
      */
-    iterator end()
+    iterator locate(size_t index) const
     {
-        return iterator(block->last(), block->last()->end(), this);
+        if (block.empty())
+            return iterator(0, 0, this);
+        size_t i = block.locate(index);
+        return iterator(i, index - block.start(i), this);
     }
-    const_iterator cend() const
+    /**
+     * take a block for at least n elements, the spare one if it fits
+     */
+    block_type* new_block(size_t n)
     {
-        return const_iterator(block->last(), block->last()->end(), this);
+        if (spare == nullptr || spare->capacity() < n)
+            return block.create(n, alloc);
+        block_type* res = spare;
+        spare = nullptr;
+        return res;
     }
-
     /**
-     * check whether the container is empty.
+     * keep an emptied block as the spare one, the larger one is kept
+     * a block still shared with a copy is only dropped
      */
-    bool empty() const
+    void free_block(block_type* blk)
     {
-        return sz == 0;
+        if (blk->shared()) {
+            block.destroy(blk);
+            return;
+        }
+        blk->clear();
+        if (spare != nullptr && spare->capacity() >= blk->capacity()) {
+            block.destroy(blk);
+            return;
+        }
+        block.destroy(spare);
+        spare = blk;
+        return;
     }
-
     /**
-     * return the number of elements.
+     * make the i-th block private to this deque before it is modified,
+     * by copying it if it is shared with a copy of this deque
      */
-    size_t size() const
+    block_type* unshare(size_t i)
     {
-        return sz;
+        return unshare(i, std::integral_constant<bool, Policy::copy_on_write>());
     }
-
     /**
-     * clear all contents.
+     * without copy-on-write no block is shared, and T needn't be copyable
      */
-    void clear()
+    block_type* unshare(size_t i, std::false_type)
     {
-        delete block;
-        block = new double_list<double_list<T>>();
-        block->insert_tail(double_list<T>());
-        length = 200;
-        sz = 0;
+        return block[i];
+    }
+    block_type* unshare(size_t i, std::true_type)
+    {
+        block_type* cur = block[i];
+        if (!sharing.load(std::memory_order_relaxed) || !cur->shared())
+            return cur;
+        block_type* res = new_block(cur->capacity());
+        try {
+            for (size_t j = 0; j < cur->size(); j++)
+                res->insert_tail((*cur)[j]);
+        } catch (...) {
+            free_block(res);
+            throw;
+        }
+        block.destroy(block.replace(i, res));
+        return res;
     }
-
     /**
-     * split the block at pos
+     * append val to the block to, moved if its block is owned by this
+     * deque alone, copied if it is shared with a copy
+     * without copy-on-write it is always moved, and T needn't be copyable
      */
-    iterator split(iterator pos)
+    void take(block_type* to, T& val, bool own, std::true_type)
     {
-        if (pos.block_it->size() <= length)
-            return pos;
-        size_t old_pos = pos.block_it->get_pos(pos.list_it);
-        auto [temp1, temp2] = pos.block_it->split(pos.block_it->size() / 2);
-        auto block1 = block->insert_ptr(pos.block_it, temp1);
-        auto block2 = block->insert_ptr(pos.block_it, temp2);
-        block->erase(pos.block_it);
-        if (old_pos < block1->size())
-            return iterator(block1, block1->begin() + old_pos, this);
+        if (own)
+            to->insert_tail(std::move(val));
         else
-            return iterator(block2, block2->begin() + (old_pos - block1->size()), this);
+            to->insert_tail(val);
+        return;
+    }
+    void take(block_type* to, T& val, bool, std::false_type)
+    {
+        to->insert_tail(std::move(val));
+        return;
     }
     /**
-     * merge the block at pos and the block at pos + 1
+     * move the elements of the i-th block from at to the end
+     * into a new block right after it
      */
-    iterator merge(iterator pos)
+    void split_block(size_t i, size_t at)
     {
-        if (pos.block_it != block->last() && pos.block_it->size() + (pos.block_it + 1)->size() <= length) {
-            size_t old_pos = pos.block_it->get_pos(pos.list_it);
-            pos.block_it->merge((pos.block_it + 1).get());
-            block->erase(pos.block_it + 1);
-            return iterator(pos.block_it, pos.block_it->begin() + old_pos, this);
+        block_type* cur = unshare(i);
+        block_type* next = cur->split(at, new_block(cur->capacity()));
+        block.adjust(i, -(long long)next->size());
+        try {
+            block.insert(i + 1, next);
+        } catch (...) {
+            block.adjust(i, next->size());
+            cur->merge(next);
+            free_block(next);
+            throw;
         }
-        if (pos.block_it != block->begin() && pos.block_it->size() + (pos.block_it - 1)->size() <= length) {
-            size_t old_pos = (pos.block_it - 1)->size() + pos.block_it->get_pos(pos.list_it);
-            (pos.block_it - 1)->merge(pos.block_it.get());
-            pos.block_it = pos.block_it - 1;
-            block->erase(pos.block_it + 1);
-            return iterator(pos.block_it, pos.block_it->begin() + old_pos, this);
+        return;
+    }
+    /**
+     * move all the elements of the (i + 1)-th block into the i-th block
+     * and remove the (i + 1)-th block
+     */
+    void merge_block(size_t i)
+    {
+        block_type* cur = unshare(i);
+        block_type* next = unshare(i + 1);
+        block.transfer(i, next->size());
+        cur->reserve(block_length());
+        cur->merge(next);
+        free_block(block.release(i + 1));
+        return;
+    }
+    /**
+     * rebalance a bounded number of blocks at the sweep cursor
+     * a block longer than length is split in halves, and a block is
+     * merged with the next one if they fit in length together.
+     * each step costs O(length), so no modification waits for a rebuild.
+     */
+    iterator rebalance(iterator pos)
+    {
+        length = target_length();
+        size_t index = index_of(pos);
+        bool changed = false;
+        for (size_t step = 0; step < 2; step++) {
+            if (cursor >= block.size())
+                cursor = 0;
+            block_type* cur = block[cursor];
+            if (cur->size() > length) {
+                split_block(cursor, cur->size() / 2);
+                changed = true;
+            } else if (cursor + 1 < block.size() && cur->size() + block[cursor + 1]->size() <= length) {
+                merge_block(cursor);
+                changed = true;
+            } else
+                cursor++;
         }
-        return pos;
+        return changed ? locate(index) : pos;
     }
     /**
-     * reconstruct the block
+     * check whether the blocks should be rebuilt under the policy
      */
-    iterator reconstruct(iterator pos)
+    bool need_reconstruct() const
     {
-        static size_t last_construct = 0, opts = 0;
-        opts++;
-        if (opts - last_construct > std::min(size(), length * length)) {
-            length = std::sqrt(size()) + 1;
-            if (length < 200)
-                length = 200;
-            last_construct = opts;
-        } else
-            return pos;
-        double_list<T>* list = new double_list<T>();
-        size_t new_pos = 0;
-        bool flag = false;
-        for (auto temp = block->begin(); temp != block->end(); temp++) {
-            if (temp != pos.block_it) {
-                if (!flag)
-                    new_pos += temp->size();
-            } else {
-                new_pos += temp->get_pos(pos.list_it);
-                flag = true;
-            }
-            list->merge(temp.get());
+        switch (policy) {
+        case rebalance_policy::amortized: {
+            size_t period = std::min(size(), length * length);
+            if (Policy::directory == block_directory::tree)
+                period = size();
+            return opts - last_construct > period;
         }
-        delete block;
-        block = new double_list<double_list<T>>();
-        size_t cnt = 0;
-        while (cnt < size()) {
-            auto [temp1, temp2] = list->split(length);
-            delete list;
-            block->insert_tail_ptr(temp1);
-            list = temp2;
-            cnt += temp1->size();
+        case rebalance_policy::threshold: {
+            size_t target = target_length();
+            return length > target * factor || length * factor < target;
+        }
+        default:
+            return false;
         }
-        if (list->size() || block->empty())
-            block->insert_tail_ptr(list);
-        delete list;
-        return begin() + new_pos;
     }
-
     /**
-     * insert value before pos.
-     * return an iterator pointing to the inserted value.
-     * throw if the iterator is invalid or it points to a wrong place.
+     * insert the elements produced by next before pos
+     * next(cur) appends one element to the block cur, or returns false
+     * if there are no more.
+     * the block at pos is split in two, and the elements fill whole new
+     * blocks linked in between, so k elements cost O(k + sqrt(n)).
      */
-    iterator insert(iterator pos, const T& value)
+    template <class Source>
+    iterator insert_blocks(iterator pos, Source next)
     {
-        if (pos.base != this)
+        if (pos.base != this || pos.stale() || (!block.empty() && (pos.bi >= block.size() || pos.pos > block[pos.bi]->size())))
             throw invalid_iterator();
-        sz++;
-        pos.list_it = pos.block_it->insert(pos.list_it, value);
-        pos = split(pos);
-        pos = reconstruct(pos);
-        return pos;
+        touch(pos);
+        size_t index = index_of(pos), at;
+        if (sz == 0) {
+            if (!block.empty())
+                free_block(block.release(0));
+            at = 0;
+        } else if (pos.pos == 0)
+            at = pos.bi;
+        else {
+            if (pos.pos < block[pos.bi]->size())
+                split_block(pos.bi, pos.pos);
+            at = pos.bi + 1;
+        }
+        size_t start = at;
+        block_type* cur = new_block(block_length());
+        try {
+            while (next(cur)) {
+                if (!cur->full())
+                    continue;
+                sz += cur->size();
+                block.insert(at++, cur);
+                cur = nullptr;
+                cur = new_block(block_length());
+            }
+        } catch (...) {
+            if (cur != nullptr && !cur->empty()) {
+                sz += cur->size();
+                block.insert(at++, cur);
+            } else if (cur != nullptr)
+                free_block(cur);
+            throw;
+        }
+        if (cur->empty())
+            free_block(cur);
+        else {
+            sz += cur->size();
+            block.insert(at++, cur);
+        }
+        if (at == start)
+            return locate(index);
+        if (at < block.size() && block[at - 1]->size() + block[at]->size() <= block_length())
+            merge_block(at - 1);
+        if (start > 0 && block[start - 1]->size() + block[start]->size() <= block_length())
+            merge_block(start - 1);
+        return reconstruct(locate(index));
     }
-
     /**
-     * remove the element at pos.
-     * return an iterator pointing to the following element. if pos points to
-     * the last element, return end(). throw if the container is empty,
-     * the iterator is invalid, or it points to a wrong place.
+     * construct an element at the back or the front, only the block at
+     * that end is touched, and no rebuild is counted
+     * a full end block doubles its capacity below the block length,
+     * otherwise a new block is linked in, sized by the current sqrt(n)
+     * so that the blocks keep up with the growth without a rebuild
      */
-    iterator erase(iterator pos)
+    template <class... Args>
+    T& emplace_end(bool back, Args&&... args)
     {
-        if (pos == end() || pos.base != this)
-            throw invalid_iterator();
-        sz--;
-        if (pos == last()) {
-            pos.list_it = pos.block_it->erase(pos.list_it);
-            if (pos.block_it->empty() && block->size() != 1)
-                block->delete_tail();
-            return end();
+        touch();
+        block_type* cur = block.empty() ? nullptr : unshare(back ? block.size() - 1 : 0);
+        if (cur != nullptr && cur->full() && Policy::grow_blocks && cur->capacity() < length) {
+            T temp(std::forward<Args>(args)...);
+            cur->reserve(std::min(cur->capacity() * 2, length));
+            return place_end(back, cur, std::move(temp));
         }
-        pos.list_it = pos.block_it->erase(pos.list_it);
-        if (pos.list_it == pos.block_it->end()) {
-            if (pos.block_it->empty())
-                pos.block_it = block->erase(pos.block_it);
+        if (cur != nullptr && !cur->full())
+            return place_end(back, cur, std::forward<Args>(args)...);
+        if (policy != rebalance_policy::never)
+            length = target_length();
+        cur = new_block(Policy::grow_blocks && block.empty() ? std::min(length, (size_t)16) : block_length());
+        try {
+            if (back)
+                cur->emplace_tail(std::forward<Args>(args)...);
             else
-                pos.block_it++;
-            pos.list_it = pos.block_it->begin();
+                cur->emplace_head(std::forward<Args>(args)...);
+            block.insert(back ? block.size() : 0, cur);
+        } catch (...) {
+            free_block(cur);
+            throw;
         }
-        pos = merge(pos);
-        pos = reconstruct(pos);
-        return pos;
+        sz++;
+        return (*cur)[0];
     }
-
-    /**
-     * add an element to the end.
-     */
-    void push_back(const T& value)
+    template <class... Args>
+    T& place_end(bool back, block_type* cur, Args&&... args)
     {
-        insert(end(), value);
-        return;
+        if (back)
+            cur->emplace_tail(std::forward<Args>(args)...);
+        else
+            cur->emplace_head(std::forward<Args>(args)...);
+        block.adjust(back ? block.size() - 1 : 0, 1);
+        sz++;
+        return back ? (*cur)[cur->size() - 1] : (*cur)[0];
     }
-
     /**
-     * remove the last element.
-     * throw when the container is empty.
+     * remove the last or the first element, only the block at that end
+     * is touched, and it is dropped once it is empty
      */
-    void pop_back()
+    void pop_end(bool back)
     {
         if (empty())
             throw container_is_empty();
-        erase(last());
+        touch();
+        size_t i = back ? block.size() - 1 : 0;
+        block_type* cur = unshare(i);
+        if (back)
+            cur->delete_tail();
+        else
+            cur->delete_head();
+        block.adjust(i, -1);
+        sz--;
+        if (cur->empty() && block.size() != 1)
+            free_block(block.release(i));
         return;
     }
-
     /**
-     * insert an element to the beginning.
+     * split the block holding the index-th element so that the element
+     * starts a block, and return the index of that block
      */
-    void push_front(const T& value)
+    size_t cut(size_t index)
     {
-        insert(begin(), value);
-        return;
+        if (index == sz)
+            return block.size();
+        iterator pos = locate(index);
+        if (pos.pos == 0)
+            return pos.bi;
+        split_block(pos.bi, pos.pos);
+        return pos.bi + 1;
     }
-
     /**
-     * remove the first element.
-     * throw when the container is empty.
+     * take over the state of other after its blocks are relinked
+     * into this deque
      */
-    void pop_front()
+    void absorb(deque& other)
     {
-        if (empty())
-            throw container_is_empty();
-        erase(begin());
+        if (other.sharing.load())
+            sharing = true;
+        other.clear();
+        if (cursor >= block.size())
+            cursor = 0;
         return;
     }
 };
+/**
+ * exchange the contents of two deques, found by ADL
+ */
+template <class T, class Policy, class Allocator>
+void swap(deque<T, Policy, Allocator>& lhs, deque<T, Policy, Allocator>& rhs) noexcept
+{
+    lhs.swap(rhs);
+    return;
+}
+
+#ifdef __cpp_lib_memory_resource
+/**
+ * the containers on a std::pmr::memory_resource
+ */
+namespace pmr {
+template <class T>
+using double_list = sjtu::double_list<T, std::pmr::polymorphic_allocator<T>>;
+template <class T, class Policy = deque_policy<>>
+using deque = sjtu::deque<T, Policy, std::pmr::polymorphic_allocator<T>>;
+} // namespace pmr
+#endif
 
 } // namespace sjtu
 
-#endif
\ No newline at end of file
+#endif
@@ -12,38 +12,75 @@
  */
 namespace sjtu {
 
+/**
+ * the messages are static strings, so throwing, copying and catching
+ * an exception never allocates
+ */
 class exception {
 protected:
-    const std::string variant = "";
-    std::string detail = "";
+    const char* variant = "";
+    const char* detail = "";
+
+    exception(const char* variant, const char* detail) noexcept
+        : variant(variant)
+        , detail(detail)
+    {
+    }
 
 public:
-    exception() { }
-    exception(const exception& ec)
+    exception() noexcept { }
+    exception(const exception& ec) noexcept
         : variant(ec.variant)
         , detail(ec.detail)
     {
     }
-    virtual std::string what()
+    virtual ~exception() = default;
+    /**
+     * the name of the exception
+     */
+    virtual const char* what() const noexcept
     {
-        return variant + " " + detail;
+        return variant;
+    }
+    /**
+     * what went wrong
+     */
+    const char* reason() const noexcept
+    {
+        return detail;
     }
 };
 
 class index_out_of_bound : public exception {
-    /* __________________________ */
+public:
+    index_out_of_bound() noexcept
+        : exception("index_out_of_bound", "the index is out of the bounds of the container")
+    {
+    }
 };
 
 class runtime_error : public exception {
-    /* __________________________ */
+public:
+    runtime_error() noexcept
+        : exception("runtime_error", "the operation is not supported in this state")
+    {
+    }
 };
 
 class invalid_iterator : public exception {
-    /* __________________________ */
+public:
+    invalid_iterator() noexcept
+        : exception("invalid_iterator", "the iterator doesn't point into the container")
+    {
+    }
 };
 
 class container_is_empty : public exception {
-    /* __________________________ */
+public:
+    container_is_empty() noexcept
+        : exception("container_is_empty", "the container has no element")
+    {
+    }
 };
 }
 
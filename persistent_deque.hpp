@@ -0,0 +1,522 @@
+#ifndef SJTU_PERSISTENT_DEQUE_HPP
+#define SJTU_PERSISTENT_DEQUE_HPP
+
+#include "exceptions.hpp"
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace sjtu {
+/**
+ * an immutable deque, every modification returns a new version and
+ * leaves the old one untouched
+ * the elements are kept in a treap ordered by position, a new version
+ * copies the O(log n) nodes on the paths it changes and shares all the
+ * other nodes with the old one, so copying a version is O(1)
+ * the nodes count their references atomically, so versions may be read
+ * and dropped on several threads
+ */
+template <class T>
+class persistent_deque {
+private:
+    struct Node {
+        T val;
+        Node *l, *r;
+        size_t sz, pri;
+        std::atomic<size_t> refs;
+        /**
+         * a node over the children l and r, taking a reference to both
+         */
+        template <class... Args>
+        Node(Node* l, Node* r, size_t pri, Args&&... args)
+            : val(std::forward<Args>(args)...)
+            , l(l)
+            , r(r)
+            , sz(size(l) + size(r) + 1)
+            , pri(pri)
+            , refs(1)
+        {
+            acquire(l);
+            acquire(r);
+        }
+    };
+    Node* root;
+
+    /**
+     * a version over root, taking over the reference to it
+     */
+    explicit persistent_deque(Node* root)
+        : root(root)
+    {
+    }
+
+    static size_t size(const Node* p)
+    {
+        return p == nullptr ? 0 : p->sz;
+    }
+    static void acquire(Node* p)
+    {
+        if (p != nullptr)
+            p->refs.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    /**
+     * drop a reference to p, and delete the nodes no version uses
+     * any more
+     */
+    static void release(Node* p)
+    {
+        while (p != nullptr && p->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            release(p->l);
+            Node* next = p->r;
+            delete p;
+            p = next;
+        }
+        return;
+    }
+    /**
+     * a random priority for a new node
+     */
+    static size_t priority()
+    {
+        static std::atomic<unsigned long long> seed(0);
+        unsigned long long x = seed.fetch_add(0x9e3779b97f4a7c15ULL, std::memory_order_relaxed) + 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+    /**
+     * a copy of p over the children l and r
+     * the reference to owned is dropped in any case
+     */
+    static Node* rebuild(const Node* p, Node* l, Node* r, Node* owned)
+    {
+        Node* res;
+        try {
+            res = new Node(l, r, p->pri, p->val);
+        } catch (...) {
+            release(owned);
+            throw;
+        }
+        release(owned);
+        return res;
+    }
+    /**
+     * split p into its first k elements (a) and the others (b)
+     * p is not changed, a and b are new references
+     */
+    static void split(Node* p, size_t k, Node*& a, Node*& b)
+    {
+        if (k == 0 || k >= size(p)) {
+            a = k == 0 ? nullptr : p;
+            b = k == 0 ? p : nullptr;
+            acquire(p);
+            return;
+        }
+        Node* t;
+        if (k <= size(p->l)) {
+            split(p->l, k, a, t);
+            try {
+                b = rebuild(p, t, p->r, t);
+            } catch (...) {
+                release(a);
+                throw;
+            }
+        } else {
+            split(p->r, k - size(p->l) - 1, t, b);
+            try {
+                a = rebuild(p, p->l, t, t);
+            } catch (...) {
+                release(b);
+                throw;
+            }
+        }
+        return;
+    }
+    /**
+     * the concatenation of a and b, as a new reference
+     * a and b are not changed
+     */
+    static Node* merge(Node* a, Node* b)
+    {
+        if (a == nullptr || b == nullptr) {
+            Node* res = a == nullptr ? b : a;
+            acquire(res);
+            return res;
+        }
+        if (a->pri > b->pri) {
+            Node* t = merge(a->r, b);
+            return rebuild(a, a->l, t, t);
+        }
+        Node* t = merge(a, b->l);
+        return rebuild(b, t, b->r, t);
+    }
+    /**
+     * p with the k-th element constructed from args, as a new reference
+     */
+    template <class... Args>
+    static Node* assign(Node* p, size_t k, Args&&... args)
+    {
+        size_t ls = size(p->l);
+        if (k == ls)
+            return new Node(p->l, p->r, p->pri, std::forward<Args>(args)...);
+        if (k < ls) {
+            Node* t = assign(p->l, k, std::forward<Args>(args)...);
+            return rebuild(p, t, p->r, t);
+        }
+        Node* t = assign(p->r, k - ls - 1, std::forward<Args>(args)...);
+        return rebuild(p, p->l, t, t);
+    }
+    /**
+     * the version with an element constructed from args before
+     * the k-th element
+     */
+    template <class... Args>
+    persistent_deque emplace_at(size_t k, Args&&... args) const
+    {
+        Node *a, *b;
+        split(root, k, a, b);
+        persistent_deque left(a), right(b);
+        persistent_deque mid(new Node(nullptr, nullptr, priority(), std::forward<Args>(args)...));
+        persistent_deque temp(merge(left.root, mid.root));
+        return persistent_deque(merge(temp.root, right.root));
+    }
+    /**
+     * the version without the k-th element
+     */
+    persistent_deque erase_at(size_t k) const
+    {
+        Node *a, *b;
+        split(root, k, a, b);
+        persistent_deque left(a), rest(b);
+        split(rest.root, 1, a, b);
+        persistent_deque mid(a), right(b);
+        return persistent_deque(merge(left.root, right.root));
+    }
+    /**
+     * the k-th element, without bound checking
+     */
+    const T& get(size_t k) const
+    {
+        const Node* p = root;
+        while (true) {
+            size_t ls = size(p->l);
+            if (k == ls)
+                return p->val;
+            if (k < ls)
+                p = p->l;
+            else {
+                k -= ls + 1;
+                p = p->r;
+            }
+        }
+    }
+
+public:
+    /**
+     * the iterator of persistent_deque
+     * the elements can't be modified, so there is only a const_iterator
+     * an access walks down from the root, in O(log n)
+     */
+    class const_iterator {
+        friend persistent_deque;
+
+    protected:
+        const persistent_deque* base;
+        size_t pos;
+
+    public:
+        const_iterator()
+            : base(nullptr)
+            , pos(0)
+        {
+        }
+        const_iterator(const persistent_deque* base, size_t pos)
+            : base(base)
+            , pos(pos)
+        {
+        }
+
+        /**
+         * return a new iterator which points to the n-next element.
+         * throw invalid_iterator if it goes out of the version.
+         */
+        const_iterator operator+(const int& n) const
+        {
+            if (n < 0)
+                return *this - (-n);
+            if (base == nullptr || pos + n > base->size())
+                throw invalid_iterator();
+            return const_iterator(base, pos + n);
+        }
+        const_iterator operator-(const int& n) const
+        {
+            if (n < 0)
+                return *this + (-n);
+            if (base == nullptr || (size_t)n > pos)
+                throw invalid_iterator();
+            return const_iterator(base, pos - n);
+        }
+        /**
+         * return the distance between two iterators.
+         * throw invalid_iterator if they point to different versions.
+         */
+        int operator-(const const_iterator& rhs) const
+        {
+            if (base != rhs.base)
+                throw invalid_iterator();
+            return (int)pos - (int)rhs.pos;
+        }
+        const_iterator& operator+=(const int& n)
+        {
+            *this = *this + n;
+            return *this;
+        }
+        const_iterator& operator-=(const int& n)
+        {
+            *this = *this - n;
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+        const_iterator& operator++()
+        {
+            if (base == nullptr || pos >= base->size())
+                throw invalid_iterator();
+            pos++;
+            return *this;
+        }
+        const_iterator operator--(int)
+        {
+            const_iterator temp = *this;
+            --(*this);
+            return temp;
+        }
+        const_iterator& operator--()
+        {
+            if (base == nullptr || pos == 0)
+                throw invalid_iterator();
+            pos--;
+            return *this;
+        }
+
+        const T* get() const
+        {
+            if (base == nullptr || pos >= base->size())
+                throw invalid_iterator();
+            return &base->get(pos);
+        }
+        const T& operator*() const
+        {
+            return *get();
+        }
+        const T* operator->() const
+        {
+            return get();
+        }
+
+        bool operator==(const const_iterator& rhs) const
+        {
+            return pos == rhs.pos && base == rhs.base;
+        }
+        bool operator!=(const const_iterator& rhs) const
+        {
+            return pos != rhs.pos || base != rhs.base;
+        }
+    };
+    using iterator = const_iterator;
+
+    /**
+     * constructors and destructors
+     * a copy shares all the nodes, in O(1)
+     */
+    persistent_deque()
+        : root(nullptr)
+    {
+    }
+    persistent_deque(const persistent_deque& other)
+        : root(other.root)
+    {
+        acquire(root);
+    }
+    persistent_deque(persistent_deque&& other) noexcept
+        : root(other.root)
+    {
+        other.root = nullptr;
+    }
+    ~persistent_deque()
+    {
+        release(root);
+    }
+    persistent_deque& operator=(const persistent_deque& other)
+    {
+        acquire(other.root);
+        release(root);
+        root = other.root;
+        return *this;
+    }
+    persistent_deque& operator=(persistent_deque&& other) noexcept
+    {
+        std::swap(root, other.root);
+        return *this;
+    }
+    void swap(persistent_deque& other) noexcept
+    {
+        std::swap(root, other.root);
+        return;
+    }
+
+    size_t size() const
+    {
+        return size(root);
+    }
+    bool empty() const
+    {
+        return root == nullptr;
+    }
+
+    /**
+     * access a specified element with bound checking.
+     * throw index_out_of_bound if out of bound.
+     */
+    const T& at(const int& pos) const
+    {
+        if (pos < 0 || (size_t)pos >= size())
+            throw index_out_of_bound();
+        return get(pos);
+    }
+    const T& operator[](const int& pos) const
+    {
+        return at(pos);
+    }
+    /**
+     * access the first / last element.
+     * throw container_is_empty when the version is empty.
+     */
+    const T& front() const
+    {
+        if (empty())
+            throw container_is_empty();
+        return get(0);
+    }
+    const T& back() const
+    {
+        if (empty())
+            throw container_is_empty();
+        return get(size() - 1);
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(this, 0);
+    }
+    const_iterator cbegin() const
+    {
+        return begin();
+    }
+    const_iterator end() const
+    {
+        return const_iterator(this, size());
+    }
+    const_iterator cend() const
+    {
+        return end();
+    }
+
+    /**
+     * the version with the element at pos replaced by value.
+     * throw index_out_of_bound if out of bound.
+     */
+    persistent_deque set(const int& pos, const T& value) const
+    {
+        if (pos < 0 || (size_t)pos >= size())
+            throw index_out_of_bound();
+        return persistent_deque(assign(root, pos, value));
+    }
+    persistent_deque set(const int& pos, T&& value) const
+    {
+        if (pos < 0 || (size_t)pos >= size())
+            throw index_out_of_bound();
+        return persistent_deque(assign(root, pos, std::move(value)));
+    }
+    /**
+     * the version with value inserted before pos.
+     * throw invalid_iterator if pos doesn't belong to this version.
+     */
+    persistent_deque insert(const_iterator pos, const T& value) const
+    {
+        if (pos.base != this || pos.pos > size())
+            throw invalid_iterator();
+        return emplace_at(pos.pos, value);
+    }
+    persistent_deque insert(const_iterator pos, T&& value) const
+    {
+        if (pos.base != this || pos.pos > size())
+            throw invalid_iterator();
+        return emplace_at(pos.pos, std::move(value));
+    }
+    /**
+     * the version without the element at pos.
+     * throw invalid_iterator if pos doesn't belong to this version
+     * or points to the end.
+     */
+    persistent_deque erase(const_iterator pos) const
+    {
+        if (pos.base != this || pos.pos >= size())
+            throw invalid_iterator();
+        return erase_at(pos.pos);
+    }
+
+    /**
+     * the version with value added to the end / the beginning.
+     */
+    persistent_deque push_back(const T& value) const
+    {
+        return emplace_at(size(), value);
+    }
+    persistent_deque push_back(T&& value) const
+    {
+        return emplace_at(size(), std::move(value));
+    }
+    persistent_deque push_front(const T& value) const
+    {
+        return emplace_at(0, value);
+    }
+    persistent_deque push_front(T&& value) const
+    {
+        return emplace_at(0, std::move(value));
+    }
+    /**
+     * the version without the last / first element.
+     * throw container_is_empty when the version is empty.
+     */
+    persistent_deque pop_back() const
+    {
+        if (empty())
+            throw container_is_empty();
+        return erase_at(size() - 1);
+    }
+    persistent_deque pop_front() const
+    {
+        if (empty())
+            throw container_is_empty();
+        return erase_at(0);
+    }
+};
+/**
+ * exchange two versions, found by ADL
+ */
+template <class T>
+void swap(persistent_deque<T>& lhs, persistent_deque<T>& rhs) noexcept
+{
+    lhs.swap(rhs);
+    return;
+}
+
+} // namespace sjtu
+
+#endif
@@ -0,0 +1,438 @@
+#ifndef SJTU_SIMD_HPP
+#define SJTU_SIMD_HPP
+
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * which vector instructions the kernels on int, long long and double
+ * ranges may use
+ * 0: none, the kernels are the standard algorithms
+ * 1: SSE2, part of every x86-64 processor
+ * 2: SSE2, and AVX2 when the processor running the program has it
+ *    (the default)
+ * the kernels are only vectorized on x86-64 with GCC or Clang.
+ */
+#ifndef SJTU_SIMD
+#define SJTU_SIMD 2
+#endif
+
+#if SJTU_SIMD > 0 && defined(__x86_64__) && defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define SJTU_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SJTU_SIMD_X86 0
+#endif
+
+namespace sjtu {
+struct sse2_int;
+struct sse2_long_long;
+struct sse2_double;
+struct avx2_int;
+struct avx2_long_long;
+struct avx2_double;
+#if SJTU_SIMD_X86
+/**
+ * the lanes of a vector register, for each instruction set and element
+ * type: load, broadcast, the bit mask of the lanes equal between two
+ * registers, lane-wise min, max and sum, the bit mask of the NaN lanes
+ * (always 0 for integers), and a counter register adding 1 to a lane
+ * for each equal pair seen there
+ * the SSE2 integer comparisons missing from the instruction set are
+ * built from the 32-bit ones.
+ */
+struct sse2_int {
+    typedef int value_type;
+    typedef __m128i reg;
+    static const size_t lanes = 4;
+    static reg load(const int* p) { return _mm_loadu_si128((const __m128i*)p); }
+    static void store(int* p, reg a) { _mm_storeu_si128((__m128i*)p, a); }
+    static reg set1(int x) { return _mm_set1_epi32(x); }
+    static int eq(reg a, reg b) { return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))); }
+    static reg select(reg m, reg a, reg b) { return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); }
+    static reg min(reg a, reg b) { return select(_mm_cmpgt_epi32(a, b), b, a); }
+    static reg max(reg a, reg b) { return select(_mm_cmpgt_epi32(a, b), a, b); }
+    static reg add(reg a, reg b) { return _mm_add_epi32(a, b); }
+    static int nan(reg) { return 0; }
+    typedef __m128i counter;
+    static counter none() { return _mm_setzero_si128(); }
+    static counter tally(counter acc, reg a, reg b) { return _mm_sub_epi32(acc, _mm_cmpeq_epi32(a, b)); }
+    static size_t total(counter acc)
+    {
+        unsigned int lane[4];
+        _mm_storeu_si128((__m128i*)lane, acc);
+        size_t res = 0;
+        for (size_t i = 0; i < 4; i++)
+            res += lane[i];
+        return res;
+    }
+};
+struct sse2_long_long {
+    typedef long long value_type;
+    typedef __m128i reg;
+    static const size_t lanes = 2;
+    static reg load(const long long* p) { return _mm_loadu_si128((const __m128i*)p); }
+    static void store(long long* p, reg a) { _mm_storeu_si128((__m128i*)p, a); }
+    static reg set1(long long x) { return _mm_set1_epi64x(x); }
+    static int eq(reg a, reg b)
+    {
+        reg c = _mm_cmpeq_epi32(a, b);
+        return _mm_movemask_pd(_mm_castsi128_pd(_mm_and_si128(c, _mm_shuffle_epi32(c, _MM_SHUFFLE(2, 3, 0, 1)))));
+    }
+    /**
+     * a > b: the high halves compare signed, the low ones unsigned
+     */
+    static reg gt(reg a, reg b)
+    {
+        reg flip = _mm_set1_epi64x(0x80000000LL);
+        reg high = _mm_cmpgt_epi32(a, b), same = _mm_cmpeq_epi32(a, b);
+        reg low = _mm_cmpgt_epi32(_mm_xor_si128(a, flip), _mm_xor_si128(b, flip));
+        reg res = _mm_or_si128(high, _mm_and_si128(same, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 2, 0, 0))));
+        return _mm_shuffle_epi32(res, _MM_SHUFFLE(3, 3, 1, 1));
+    }
+    static reg select(reg m, reg a, reg b) { return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); }
+    static reg min(reg a, reg b) { return select(gt(a, b), b, a); }
+    static reg max(reg a, reg b) { return select(gt(a, b), a, b); }
+    static reg add(reg a, reg b) { return _mm_add_epi64(a, b); }
+    static int nan(reg) { return 0; }
+    typedef __m128i counter;
+    static counter none() { return _mm_setzero_si128(); }
+    static counter tally(counter acc, reg a, reg b)
+    {
+        reg c = _mm_cmpeq_epi32(a, b);
+        return _mm_sub_epi64(acc, _mm_and_si128(c, _mm_shuffle_epi32(c, _MM_SHUFFLE(2, 3, 0, 1))));
+    }
+    static size_t total(counter acc)
+    {
+        unsigned long long lane[2];
+        _mm_storeu_si128((__m128i*)lane, acc);
+        size_t res = 0;
+        for (size_t i = 0; i < 2; i++)
+            res += lane[i];
+        return res;
+    }
+};
+struct sse2_double {
+    typedef double value_type;
+    typedef __m128d reg;
+    static const size_t lanes = 2;
+    static reg load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, reg a) { _mm_storeu_pd(p, a); }
+    static reg set1(double x) { return _mm_set1_pd(x); }
+    static int eq(reg a, reg b) { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)); }
+    static reg min(reg a, reg b) { return _mm_min_pd(a, b); }
+    static reg max(reg a, reg b) { return _mm_max_pd(a, b); }
+    static reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+    static int nan(reg a) { return _mm_movemask_pd(_mm_cmpunord_pd(a, a)); }
+    typedef __m128i counter;
+    static counter none() { return _mm_setzero_si128(); }
+    static counter tally(counter acc, reg a, reg b) { return _mm_sub_epi64(acc, _mm_castpd_si128(_mm_cmpeq_pd(a, b))); }
+    static size_t total(counter acc)
+    {
+        unsigned long long lane[2];
+        _mm_storeu_si128((__m128i*)lane, acc);
+        size_t res = 0;
+        for (size_t i = 0; i < 2; i++)
+            res += lane[i];
+        return res;
+    }
+};
+
+/**
+ * the loops of the kernels over a range, a register at a time and the
+ * rest one by one
+ * min_element finds the extreme value first, then its first position,
+ * and gives up (returning last) on a NaN, which has no place in the
+ * order of operator<.
+ */
+template <class V>
+struct sse2_loop {
+    typedef typename V::value_type T;
+    static const T* find(const T* first, const T* last, T value)
+    {
+        typename V::reg v = V::set1(value);
+        for (; (size_t)(last - first) >= 2 * V::lanes; first += 2 * V::lanes) {
+            int m = V::eq(V::load(first), v) | V::eq(V::load(first + V::lanes), v) << V::lanes;
+            if (m != 0)
+                return first + __builtin_ctz(m);
+        }
+        return std::find(first, last, value);
+    }
+    static size_t count(const T* first, const T* last, T value)
+    {
+        typename V::reg v = V::set1(value);
+        typename V::counter acc = V::none();
+        for (; (size_t)(last - first) >= V::lanes; first += V::lanes)
+            acc = V::tally(acc, V::load(first), v);
+        return V::total(acc) + std::count(first, last, value);
+    }
+    static const T* extreme(const T* first, const T* last, bool largest)
+    {
+        if ((size_t)(last - first) < V::lanes) {
+            for (const T* p = first; p != last; ++p) {
+                if (*p != *p)
+                    return last;
+            }
+            return largest ? std::max_element(first, last) : std::min_element(first, last);
+        }
+        typename V::reg acc = V::load(first);
+        int nan = V::nan(acc);
+        const T* p = first + V::lanes;
+        for (; (size_t)(last - p) >= V::lanes; p += V::lanes) {
+            typename V::reg x = V::load(p);
+            nan |= V::nan(x);
+            acc = largest ? V::max(acc, x) : V::min(acc, x);
+        }
+        T lane[V::lanes];
+        V::store(lane, acc);
+        T res = lane[0];
+        for (size_t i = 1; i < V::lanes; i++)
+            res = largest ? std::max(res, lane[i]) : std::min(res, lane[i]);
+        for (; p != last; ++p) {
+            if (*p != *p)
+                nan = 1;
+            res = largest ? std::max(res, *p) : std::min(res, *p);
+        }
+        return nan != 0 ? last : find(first, last, res);
+    }
+    static T sum(const T* first, const T* last, T init)
+    {
+        typename V::reg acc = V::set1(0);
+        for (; (size_t)(last - first) >= V::lanes; first += V::lanes)
+            acc = V::add(acc, V::load(first));
+        T lane[V::lanes];
+        V::store(lane, acc);
+        for (size_t i = 0; i < V::lanes; i++)
+            init += lane[i];
+        for (; first != last; ++first)
+            init += *first;
+        return init;
+    }
+};
+
+#if SJTU_SIMD >= 2
+#define SJTU_AVX2 __attribute__((target("avx2")))
+struct avx2_int {
+    typedef int value_type;
+    typedef __m256i reg;
+    static const size_t lanes = 8;
+    SJTU_AVX2 static reg load(const int* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    SJTU_AVX2 static void store(int* p, reg a) { _mm256_storeu_si256((__m256i*)p, a); }
+    SJTU_AVX2 static reg set1(int x) { return _mm256_set1_epi32(x); }
+    SJTU_AVX2 static int eq(reg a, reg b) { return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))); }
+    SJTU_AVX2 static reg min(reg a, reg b) { return _mm256_min_epi32(a, b); }
+    SJTU_AVX2 static reg max(reg a, reg b) { return _mm256_max_epi32(a, b); }
+    SJTU_AVX2 static reg add(reg a, reg b) { return _mm256_add_epi32(a, b); }
+    SJTU_AVX2 static int nan(reg) { return 0; }
+    typedef __m256i counter;
+    SJTU_AVX2 static counter none() { return _mm256_setzero_si256(); }
+    SJTU_AVX2 static counter tally(counter acc, reg a, reg b) { return _mm256_sub_epi32(acc, _mm256_cmpeq_epi32(a, b)); }
+    SJTU_AVX2 static size_t total(counter acc)
+    {
+        unsigned int lane[8];
+        _mm256_storeu_si256((__m256i*)lane, acc);
+        size_t res = 0;
+        for (size_t i = 0; i < 8; i++)
+            res += lane[i];
+        return res;
+    }
+};
+struct avx2_long_long {
+    typedef long long value_type;
+    typedef __m256i reg;
+    static const size_t lanes = 4;
+    SJTU_AVX2 static reg load(const long long* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    SJTU_AVX2 static void store(long long* p, reg a) { _mm256_storeu_si256((__m256i*)p, a); }
+    SJTU_AVX2 static reg set1(long long x) { return _mm256_set1_epi64x(x); }
+    SJTU_AVX2 static int eq(reg a, reg b) { return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b))); }
+    SJTU_AVX2 static reg min(reg a, reg b) { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+    SJTU_AVX2 static reg max(reg a, reg b) { return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b)); }
+    SJTU_AVX2 static reg add(reg a, reg b) { return _mm256_add_epi64(a, b); }
+    SJTU_AVX2 static int nan(reg) { return 0; }
+    typedef __m256i counter;
+    SJTU_AVX2 static counter none() { return _mm256_setzero_si256(); }
+    SJTU_AVX2 static counter tally(counter acc, reg a, reg b) { return _mm256_sub_epi64(acc, _mm256_cmpeq_epi64(a, b)); }
+    SJTU_AVX2 static size_t total(counter acc)
+    {
+        unsigned long long lane[4];
+        _mm256_storeu_si256((__m256i*)lane, acc);
+        size_t res = 0;
+        for (size_t i = 0; i < 4; i++)
+            res += lane[i];
+        return res;
+    }
+};
+struct avx2_double {
+    typedef double value_type;
+    typedef __m256d reg;
+    static const size_t lanes = 4;
+    SJTU_AVX2 static reg load(const double* p) { return _mm256_loadu_pd(p); }
+    SJTU_AVX2 static void store(double* p, reg a) { _mm256_storeu_pd(p, a); }
+    SJTU_AVX2 static reg set1(double x) { return _mm256_set1_pd(x); }
+    SJTU_AVX2 static int eq(reg a, reg b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+    SJTU_AVX2 static reg min(reg a, reg b) { return _mm256_min_pd(a, b); }
+    SJTU_AVX2 static reg max(reg a, reg b) { return _mm256_max_pd(a, b); }
+    SJTU_AVX2 static reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+    SJTU_AVX2 static int nan(reg a) { return _mm256_movemask_pd(_mm256_cmp_pd(a, a, _CMP_UNORD_Q)); }
+    typedef __m256i counter;
+    SJTU_AVX2 static counter none() { return _mm256_setzero_si256(); }
+    SJTU_AVX2 static counter tally(counter acc, reg a, reg b) { return _mm256_sub_epi64(acc, _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_EQ_OQ))); }
+    SJTU_AVX2 static size_t total(counter acc)
+    {
+        unsigned long long lane[4];
+        _mm256_storeu_si256((__m256i*)lane, acc);
+        size_t res = 0;
+        for (size_t i = 0; i < 4; i++)
+            res += lane[i];
+        return res;
+    }
+};
+
+/**
+ * the loops of sse2_loop, compiled for AVX2
+ */
+template <class V>
+struct avx2_loop {
+    typedef typename V::value_type T;
+    SJTU_AVX2 static const T* find(const T* first, const T* last, T value)
+    {
+        typename V::reg v = V::set1(value);
+        for (; (size_t)(last - first) >= 2 * V::lanes; first += 2 * V::lanes) {
+            int m = V::eq(V::load(first), v) | V::eq(V::load(first + V::lanes), v) << V::lanes;
+            if (m != 0)
+                return first + __builtin_ctz(m);
+        }
+        return std::find(first, last, value);
+    }
+    SJTU_AVX2 static size_t count(const T* first, const T* last, T value)
+    {
+        typename V::reg v = V::set1(value);
+        typename V::counter acc = V::none();
+        for (; (size_t)(last - first) >= V::lanes; first += V::lanes)
+            acc = V::tally(acc, V::load(first), v);
+        return V::total(acc) + std::count(first, last, value);
+    }
+    SJTU_AVX2 static const T* extreme(const T* first, const T* last, bool largest)
+    {
+        if ((size_t)(last - first) < V::lanes) {
+            for (const T* p = first; p != last; ++p) {
+                if (*p != *p)
+                    return last;
+            }
+            return largest ? std::max_element(first, last) : std::min_element(first, last);
+        }
+        typename V::reg acc = V::load(first);
+        int nan = V::nan(acc);
+        const T* p = first + V::lanes;
+        for (; (size_t)(last - p) >= V::lanes; p += V::lanes) {
+            typename V::reg x = V::load(p);
+            nan |= V::nan(x);
+            acc = largest ? V::max(acc, x) : V::min(acc, x);
+        }
+        T lane[V::lanes];
+        V::store(lane, acc);
+        T res = lane[0];
+        for (size_t i = 1; i < V::lanes; i++)
+            res = largest ? std::max(res, lane[i]) : std::min(res, lane[i]);
+        for (; p != last; ++p) {
+            if (*p != *p)
+                nan = 1;
+            res = largest ? std::max(res, *p) : std::min(res, *p);
+        }
+        return nan != 0 ? last : find(first, last, res);
+    }
+    SJTU_AVX2 static T sum(const T* first, const T* last, T init)
+    {
+        typename V::reg acc = V::set1(0);
+        for (; (size_t)(last - first) >= V::lanes; first += V::lanes)
+            acc = V::add(acc, V::load(first));
+        T lane[V::lanes];
+        V::store(lane, acc);
+        for (size_t i = 0; i < V::lanes; i++)
+            init += lane[i];
+        for (; first != last; ++first)
+            init += *first;
+        return init;
+    }
+};
+#undef SJTU_AVX2
+
+/**
+ * whether the processor running the program has AVX2, checked once
+ */
+inline bool has_avx2()
+{
+    static const bool res = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return res;
+}
+#endif
+#endif
+
+/**
+ * the kernels on a range [first, last) of T, picking the widest
+ * instruction set available
+ * enabled tells whether T has vectorized kernels (int, long long and
+ * double), the other members only exist when it does.
+ * find and count compare with operator==, min_element and max_element
+ * give the first extreme element like the standard ones, or last on an
+ * empty range or one holding a NaN. sum adds the elements to init in
+ * an unspecified order, and is only meant for integers.
+ */
+template <class T>
+struct simd_kernels {
+    static const bool enabled = false;
+};
+
+template <class T, class Sse2, class Avx2>
+struct simd_dispatch {
+    static const bool enabled = true;
+#if SJTU_SIMD_X86 && SJTU_SIMD >= 2
+#define SJTU_SIMD_CALL(f, ...) (has_avx2() ? avx2_loop<Avx2>::f(__VA_ARGS__) : sse2_loop<Sse2>::f(__VA_ARGS__))
+#elif SJTU_SIMD_X86
+#define SJTU_SIMD_CALL(f, ...) sse2_loop<Sse2>::f(__VA_ARGS__)
+#endif
+
+#ifdef SJTU_SIMD_CALL
+    static const T* find(const T* first, const T* last, T value) { return SJTU_SIMD_CALL(find, first, last, value); }
+    static size_t count(const T* first, const T* last, T value) { return SJTU_SIMD_CALL(count, first, last, value); }
+    static const T* min_element(const T* first, const T* last) { return SJTU_SIMD_CALL(extreme, first, last, false); }
+    static const T* max_element(const T* first, const T* last) { return SJTU_SIMD_CALL(extreme, first, last, true); }
+    static T sum(const T* first, const T* last, T init) { return SJTU_SIMD_CALL(sum, first, last, init); }
+#undef SJTU_SIMD_CALL
+#else
+    static const T* find(const T* first, const T* last, T value) { return std::find(first, last, value); }
+    static size_t count(const T* first, const T* last, T value) { return std::count(first, last, value); }
+    static const T* min_element(const T* first, const T* last) { return unordered(first, last) ? last : std::min_element(first, last); }
+    static const T* max_element(const T* first, const T* last) { return unordered(first, last) ? last : std::max_element(first, last); }
+    static T sum(const T* first, const T* last, T init)
+    {
+        for (; first != last; ++first)
+            init += *first;
+        return init;
+    }
+    static bool unordered(const T* first, const T* last)
+    {
+        for (; first != last; ++first) {
+            if (*first != *first)
+                return true;
+        }
+        return false;
+    }
+#endif
+};
+
+template <>
+struct simd_kernels<int> : simd_dispatch<int, sse2_int, avx2_int> {
+};
+template <>
+struct simd_kernels<long long> : simd_dispatch<long long, sse2_long_long, avx2_long_long> {
+};
+template <>
+struct simd_kernels<double> : simd_dispatch<double, sse2_double, avx2_double> {
+};
+}
+
+#endif
@@ -0,0 +1,113 @@
+/***********************************************************************
+Test for the copy-on-write policy: copies share their blocks until one of
+them writes, and every copy is checked against a std::deque, including
+iterators kept across writes, detach() and the end of the source.
+***********************************************************************/
+#include "deque.hpp"
+#include <deque>
+#include <iostream>
+#include <vector>
+
+typedef sjtu::deque_policy<0, true, sjtu::rebalance_policy::amortized, 2, true> cow;
+typedef sjtu::deque_policy<7, false, sjtu::rebalance_policy::amortized, 2, true, sjtu::block_directory::tree> small_cow;
+
+long long randNum(long long x, long long maxNum)
+{
+    x = (x * 10007) % maxNum;
+    return x + 1;
+}
+const int N = 20005;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+template <class D>
+void check(const D& a, const std::deque<int>& b)
+{
+    if (a.size() != b.size())
+        error();
+    size_t i = 0;
+    for (auto it = a.cbegin(); it != a.cend(); ++it, ++i) {
+        if (*it != b[i])
+            error();
+    }
+}
+
+template <class P>
+void TestIterators()
+{
+    std::cout << "Test 1 : Test for iterators kept across a write and the end of the source...";
+    sjtu::deque<int, P>* b = new sjtu::deque<int, P>;
+    for (int i = 0; i < 100; i++)
+        b->push_back(i);
+    sjtu::deque<int, P> a(*b);
+    auto it = a.begin();
+    auto mid = a.begin() + 50;
+    a[0] = 5;
+    delete b;
+    ++it;
+    if (*it != 1 || *(it + 30) != 31 || *(mid - 10) != 40 || *mid != 50 || a[0] != 5)
+        error();
+    --it;
+    if (*it != 5)
+        error();
+    sjtu::deque<int, P> c(a);
+    auto walk = c.begin();
+    c.detach();
+    a.clear();
+    for (int i = 0; i < 100; i++, ++walk) {
+        if (*walk != (i == 0 ? 5 : i))
+            error();
+    }
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestCopies()
+{
+    std::cout << "Test 2 : Test for copies written in turn...";
+    std::vector<sjtu::deque<int, P>> a(1);
+    std::vector<std::deque<int>> b(1);
+    for (int i = 0; i < N; i++) {
+        long long x = randNum(i, N);
+        size_t k = x % a.size();
+        if (i % 1000 == 0 && a.size() < 8) {
+            a.push_back(a[k]);
+            b.push_back(b[k]);
+        } else if (i % 1000 == 500 && a.size() > 1) {
+            a.erase(a.begin() + k);
+            b.erase(b.begin() + k);
+        } else if (x % 5 == 0 && !b[k].empty()) {
+            size_t pos = x % b[k].size();
+            a[k][pos] = (int)x;
+            b[k][pos] = (int)x;
+        } else if (x % 5 == 1 && !b[k].empty()) {
+            size_t pos = x % b[k].size();
+            a[k].erase(a[k].begin() + pos);
+            b[k].erase(b[k].begin() + pos);
+        } else if (x % 5 == 2) {
+            size_t pos = x % (b[k].size() + 1);
+            a[k].insert(a[k].begin() + pos, (int)x);
+            b[k].insert(b[k].begin() + pos, (int)x);
+        } else {
+            a[k].push_back((int)x);
+            b[k].push_back((int)x);
+        }
+    }
+    for (size_t k = 0; k < a.size(); k++)
+        check(a[k], b[k]);
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    TestIterators<cow>();
+    TestCopies<cow>();
+    TestIterators<small_cow>();
+    TestCopies<small_cow>();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
@@ -0,0 +1,286 @@
+/***********************************************************************
+Test for moving and swapping deques: move construction and assignment
+take the blocks of the source, which is left empty and usable, swap
+exchanges the contents, and with unequal allocators that don't propagate
+the elements are moved one by one into the memory of the target,
+including two deques on different std::pmr::memory_resources.
+***********************************************************************/
+#include "deque.hpp"
+#include <deque>
+#include <iostream>
+#include <string>
+#include <utility>
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+
+typedef sjtu::deque_policy<> plain;
+typedef sjtu::deque_policy<6, false, sjtu::rebalance_policy::amortized, 2, true, sjtu::block_directory::tree> small_cow;
+
+const int N = 5005;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+long long live_bytes[3];
+
+/**
+ * a stateful allocator counting the bytes of each id, equal to another
+ * one only with the same id
+ */
+template <class T, bool Propagate>
+struct tagged_allocator {
+    typedef T value_type;
+    typedef std::integral_constant<bool, Propagate> propagate_on_container_move_assignment;
+    typedef std::integral_constant<bool, Propagate> propagate_on_container_swap;
+    template <class U>
+    struct rebind {
+        typedef tagged_allocator<U, Propagate> other;
+    };
+    int id;
+    tagged_allocator(int id = 0)
+        : id(id)
+    {
+    }
+    template <class U>
+    tagged_allocator(const tagged_allocator<U, Propagate>& other)
+        : id(other.id)
+    {
+    }
+    T* allocate(size_t n)
+    {
+        live_bytes[id] += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n)
+    {
+        live_bytes[id] -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+        return;
+    }
+    template <class U>
+    bool operator==(const tagged_allocator<U, Propagate>& rhs) const { return id == rhs.id; }
+    template <class U>
+    bool operator!=(const tagged_allocator<U, Propagate>& rhs) const { return id != rhs.id; }
+};
+
+template <class D>
+void check(const D& a, const std::deque<std::string>& b)
+{
+    if (a.size() != b.size() || a.empty() != b.empty())
+        error();
+    size_t i = 0;
+    for (auto it = a.cbegin(); it != a.cend(); ++it, ++i) {
+        if (*it != b[i] || a[i] != b[i])
+            error();
+    }
+}
+
+template <class D>
+void fill(D& a, std::deque<std::string>& b, int first, int last)
+{
+    for (int i = first; i < last; i++) {
+        std::string s = std::to_string(i) + "-" + std::string(i % 20, 'x');
+        if (i % 3 == 0) {
+            a.push_front(s);
+            b.push_front(s);
+        } else if (i % 3 == 1) {
+            a.push_back(s);
+            b.push_back(s);
+        } else {
+            a.insert(a.begin() + b.size() / 2, s);
+            b.insert(b.begin() + b.size() / 2, s);
+        }
+    }
+}
+
+/**
+ * the source of a move must be empty and still usable
+ */
+template <class D>
+void checkUsable(D& a)
+{
+    std::deque<std::string> b;
+    check(a, b);
+    fill(a, b, 0, 100);
+    check(a, b);
+    a.clear();
+}
+
+template <class P>
+void TestMove()
+{
+    std::cout << "Test 1 : Test for move construction and move assignment...";
+    typedef sjtu::deque<std::string, P> D;
+    D a;
+    std::deque<std::string> b;
+    fill(a, b, 0, N);
+    D c(std::move(a));
+    check(c, b);
+    checkUsable(a);
+    D copy(c);
+    D d;
+    std::deque<std::string> e;
+    fill(d, e, N, N + 100);
+    d = std::move(c);
+    check(d, b);
+    checkUsable(c);
+    d = std::move(d);
+    check(d, b);
+    check(copy, b);
+    d.push_back("end");
+    b.push_back("end");
+    d[0] = "begin";
+    b[0] = "begin";
+    check(d, b);
+    b.pop_back();
+    b[0] = copy[0];
+    check(copy, b);
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestSwap()
+{
+    std::cout << "Test 2 : Test for swap...";
+    typedef sjtu::deque<std::string, P> D;
+    D a, c, empty;
+    std::deque<std::string> b, d;
+    fill(a, b, 0, N);
+    fill(c, d, N, N + 777);
+    D shared(a);
+    a.swap(c);
+    check(a, d);
+    check(c, b);
+    swap(a, c);
+    check(a, b);
+    check(c, d);
+    swap(a, empty);
+    check(a, std::deque<std::string>());
+    check(empty, b);
+    checkUsable(a);
+    c.swap(c);
+    check(c, d);
+    check(shared, b);
+    empty.erase(empty.begin(), empty.begin() + N / 2);
+    b.erase(b.begin(), b.begin() + N / 2);
+    check(empty, b);
+    std::cout << "Correct." << std::endl;
+}
+
+template <bool Propagate>
+void TestAllocators()
+{
+    std::cout << "Test 3 : Test for moves between unequal allocators...";
+    typedef tagged_allocator<std::string, Propagate> A;
+    typedef sjtu::deque<std::string, plain, A> D;
+    {
+        D a(A(1)), c(A(2));
+        std::deque<std::string> b, d;
+        fill(a, b, 0, N);
+        fill(c, d, 0, 10);
+        c = std::move(a);
+        check(c, b);
+        check(a, std::deque<std::string>());
+        if (c.get_allocator().id != (Propagate ? 1 : 2) || a.get_allocator().id != 1)
+            error();
+        if (!Propagate && live_bytes[2] < (long long)(N * sizeof(std::string)))
+            error();
+        checkUsable(a);
+        D e(std::move(c));
+        if (e.get_allocator().id != (Propagate ? 1 : 2))
+            error();
+        check(e, b);
+        checkUsable(c);
+        if (Propagate) {
+            D f(A(2));
+            std::deque<std::string> g;
+            fill(f, g, 10, 20);
+            f.swap(e);
+            check(f, b);
+            check(e, g);
+            if (f.get_allocator().id != 1 || e.get_allocator().id != 2)
+                error();
+        }
+    }
+    if (live_bytes[0] != 0 || live_bytes[1] != 0 || live_bytes[2] != 0)
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+#ifdef __cpp_lib_memory_resource
+/**
+ * a memory resource counting the bytes it hands out
+ */
+class counting_resource : public std::pmr::memory_resource {
+public:
+    long long bytes = 0;
+
+private:
+    void* do_allocate(size_t n, size_t align) override
+    {
+        bytes += n;
+        return std::pmr::new_delete_resource()->allocate(n, align);
+    }
+    void do_deallocate(void* p, size_t n, size_t align) override
+    {
+        bytes -= n;
+        std::pmr::new_delete_resource()->deallocate(p, n, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+#endif
+
+void TestResources()
+{
+    std::cout << "Test 4 : Test for moves between two memory resources...";
+#ifdef __cpp_lib_memory_resource
+    counting_resource r1, r2;
+    {
+        typedef sjtu::pmr::deque<std::string> D;
+        D a(&r1), c(&r2);
+        std::deque<std::string> b;
+        fill(a, b, 0, N);
+        long long before = r2.bytes;
+        c = std::move(a);
+        check(c, b);
+        if (!a.empty() || c.get_allocator().resource() != &r2 || r2.bytes <= before)
+            error();
+        a.clear();
+        D e(std::move(c));
+        if (e.get_allocator().resource() != &r2 || !c.empty())
+            error();
+        check(e, b);
+        D f(&r2);
+        f.swap(e);
+        check(f, b);
+        check(e, std::deque<std::string>());
+        a = std::move(f);
+        check(a, b);
+        if (a.get_allocator().resource() != &r1)
+            error();
+    }
+    if (r1.bytes != 0 || r2.bytes != 0)
+        error();
+#endif
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    TestMove<plain>();
+    TestSwap<plain>();
+    TestMove<small_cow>();
+    TestSwap<small_cow>();
+    TestAllocators<false>();
+    TestAllocators<true>();
+    TestResources();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
@@ -0,0 +1,195 @@
+/***********************************************************************
+Test for range insert and range erase: empty ranges, ranges covering the
+whole deque or many blocks, and insertions from input iterators that can
+only be read once, all checked against a std::deque.
+***********************************************************************/
+#include "deque.hpp"
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+typedef sjtu::deque_policy<> plain;
+typedef sjtu::deque_policy<6, false, sjtu::rebalance_policy::amortized, 2, false, sjtu::block_directory::tree> small;
+typedef sjtu::deque_policy<0, true, sjtu::rebalance_policy::amortized, 2, true> cow;
+
+long long randNum(long long x, long long maxNum)
+{
+    x = (x * 10007) % maxNum;
+    return x + 1;
+}
+const int N = 2005;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+template <class D>
+void check(const D& a, const std::deque<int>& b)
+{
+    if (a.size() != b.size())
+        error();
+    size_t i = 0;
+    for (auto it = a.cbegin(); it != a.cend(); ++it, ++i) {
+        if (*it != b[i] || a[i] != b[i])
+            error();
+    }
+}
+
+std::string numbers(int first, int last)
+{
+    std::string res;
+    for (int i = first; i < last; i++)
+        res += std::to_string(i) + " ";
+    return res;
+}
+
+template <class P>
+void TestEmptyRanges()
+{
+    std::cout << "Test 1 : Test for empty ranges...";
+    sjtu::deque<int, P> a;
+    std::deque<int> b;
+    std::vector<int> none;
+    auto it = a.insert(a.begin(), none.begin(), none.end());
+    if (it != a.begin() || it != a.end())
+        error();
+    it = a.insert(a.end(), 0, 7);
+    if (it != a.end())
+        error();
+    it = a.erase(a.begin(), a.end());
+    if (it != a.end())
+        error();
+    check(a, b);
+    for (int i = 0; i < 300; i++) {
+        a.push_back(i);
+        b.push_back(i);
+    }
+    for (size_t at = 0; at <= b.size(); at += 13) {
+        it = a.insert(a.begin() + at, none.begin(), none.end());
+        if (it - a.begin() != (long long)at)
+            error();
+        it = a.insert(a.begin() + at, 0, 7);
+        if (it - a.begin() != (long long)at)
+            error();
+        it = a.erase(a.begin() + at, a.begin() + at);
+        if (it - a.begin() != (long long)at)
+            error();
+    }
+    check(a, b);
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestWholeRanges()
+{
+    std::cout << "Test 2 : Test for ranges covering the whole deque...";
+    sjtu::deque<int, P> a;
+    std::deque<int> b;
+    std::vector<int> v;
+    for (int i = 0; i < 1000; i++)
+        v.push_back(i);
+    for (int round = 0; round < 3; round++) {
+        auto it = a.insert(a.begin(), v.begin(), v.end());
+        b.insert(b.begin(), v.begin(), v.end());
+        if (it != a.begin())
+            error();
+        check(a, b);
+        sjtu::deque<int, P> c(a);
+        std::deque<int> d(b);
+        it = a.erase(a.begin(), a.end());
+        b.clear();
+        if (it != a.end() || !a.empty())
+            error();
+        check(a, b);
+        a.push_back(round);
+        b.push_back(round);
+        a.insert(a.end(), c.begin(), c.end());
+        b.insert(b.end(), d.begin(), d.end());
+        check(a, b);
+        a.erase(a.begin() + 1, a.end());
+        b.erase(b.begin() + 1, b.end());
+        check(a, b);
+        a.erase(a.begin(), a.end() - 1);
+        b.erase(b.begin(), b.end() - 1);
+        check(a, b);
+    }
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestManyBlocks()
+{
+    std::cout << "Test 3 : Test for ranges over many blocks...";
+    sjtu::deque<int, P> a;
+    std::deque<int> b;
+    std::vector<int> v;
+    for (int i = 0; i < N; i++) {
+        long long x = randNum(i, N);
+        v.clear();
+        for (int j = 0; j < (int)(x % 300); j++)
+            v.push_back((int)(x + j));
+        if (x % 3 != 0 || b.empty()) {
+            size_t pos = x % (b.size() + 1);
+            auto it = a.insert(a.begin() + pos, v.begin(), v.end());
+            b.insert(b.begin() + pos, v.begin(), v.end());
+            if (it - a.begin() != (long long)pos)
+                error();
+        } else {
+            size_t l = x % b.size(), r = l + (x * 7) % (b.size() - l + 1);
+            auto it = a.erase(a.begin() + l, a.begin() + r);
+            b.erase(b.begin() + l, b.begin() + r);
+            if (it - a.begin() != (long long)l)
+                error();
+        }
+        if (i % 200 == 0)
+            check(a, b);
+    }
+    check(a, b);
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestInputIterators()
+{
+    std::cout << "Test 4 : Test for insertions from input iterators...";
+    sjtu::deque<int, P> a;
+    std::deque<int> b;
+    for (int i = 0; i < 50; i++) {
+        long long x = randNum(i, N);
+        int n = (int)(x % 400);
+        size_t pos = x % (b.size() + 1);
+        std::istringstream in(numbers((int)x, (int)x + n));
+        auto it = a.insert(a.begin() + pos, std::istream_iterator<int>(in), std::istream_iterator<int>());
+        for (int j = 0; j < n; j++)
+            b.insert(b.begin() + pos + j, (int)x + j);
+        if (it - a.begin() != (long long)pos)
+            error();
+        check(a, b);
+    }
+    std::istringstream in("");
+    a.insert(a.begin() + b.size() / 2, std::istream_iterator<int>(in), std::istream_iterator<int>());
+    check(a, b);
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    TestEmptyRanges<plain>();
+    TestWholeRanges<plain>();
+    TestManyBlocks<plain>();
+    TestInputIterators<plain>();
+    TestEmptyRanges<small>();
+    TestWholeRanges<small>();
+    TestManyBlocks<small>();
+    TestInputIterators<small>();
+    TestEmptyRanges<cow>();
+    TestWholeRanges<cow>();
+    TestManyBlocks<cow>();
+    TestInputIterators<cow>();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
@@ -0,0 +1,324 @@
+/***********************************************************************
+Test for double_list on its slab pool: insertions, emplacement and
+erasures against a std::list, nodes moved to other lists by split and
+merge outliving their list, copies and moves with equal and unequal
+allocators, and the containers on a std::pmr::memory_resource. Every
+allocation and every element is counted, and all must be given back.
+***********************************************************************/
+#include "deque.hpp"
+#include <iostream>
+#include <list>
+#include <string>
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+
+long long randNum(long long x, long long maxNum)
+{
+    x = (x * 10007) % maxNum;
+    return x + 1;
+}
+const int N = 20005;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+long long allocations = 0, live_bytes = 0, alive = 0;
+
+/**
+ * an element counting its live instances, built from two arguments
+ */
+struct Item {
+    int num;
+    std::string tag;
+    Item(int num, const std::string& tag)
+        : num(num)
+        , tag(tag)
+    {
+        alive++;
+    }
+    Item(const Item& other)
+        : num(other.num)
+        , tag(other.tag)
+    {
+        alive++;
+    }
+    Item(Item&& other)
+        : num(other.num)
+        , tag(std::move(other.tag))
+    {
+        alive++;
+    }
+    Item& operator=(const Item& other) = default;
+    Item& operator=(Item&& other) = default;
+    ~Item()
+    {
+        alive--;
+    }
+    bool operator==(const Item& rhs) const
+    {
+        return num == rhs.num && tag == rhs.tag;
+    }
+};
+
+/**
+ * a counting allocator, equal to another one only with the same id
+ * it doesn't propagate, so lists with different ids move by elements
+ */
+template <class T>
+struct counting_allocator {
+    typedef T value_type;
+    int id;
+    counting_allocator(int id = 0)
+        : id(id)
+    {
+    }
+    template <class U>
+    counting_allocator(const counting_allocator<U>& other)
+        : id(other.id)
+    {
+    }
+    T* allocate(size_t n)
+    {
+        allocations++;
+        live_bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n)
+    {
+        live_bytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+        return;
+    }
+    template <class U>
+    bool operator==(const counting_allocator<U>& rhs) const { return id == rhs.id; }
+    template <class U>
+    bool operator!=(const counting_allocator<U>& rhs) const { return id != rhs.id; }
+};
+
+typedef sjtu::double_list<Item, counting_allocator<Item>> list;
+
+void check(const list& a, const std::list<Item>& b)
+{
+    if (a.size() != b.size() || a.empty() != b.empty())
+        error();
+    auto jt = b.begin();
+    for (auto it = a.cbegin(); it != a.cend(); it++, jt++) {
+        if (!(*it == *jt))
+            error();
+    }
+}
+
+void TestPool()
+{
+    std::cout << "Test 1 : Test for insertions and erasures on the slab pool...";
+    {
+        list a;
+        std::list<Item> b;
+        if (allocations != 0)
+            error();
+        for (int i = 0; i < N; i++) {
+            long long x = randNum(i, N);
+            std::string tag = std::to_string(x % 7);
+            size_t pos = x % (b.size() + 1);
+            auto jt = b.begin();
+            std::advance(jt, pos);
+            switch (x % 6) {
+            case 0:
+                a.emplace(a.begin() + pos, (int)x, tag);
+                b.emplace(jt, (int)x, tag);
+                break;
+            case 1:
+                a.insert(a.begin() + pos, Item((int)x, tag));
+                b.insert(jt, Item((int)x, tag));
+                break;
+            case 2:
+                a.insert_ptr(a.begin() + pos, new Item((int)x, tag));
+                b.insert(jt, Item((int)x, tag));
+                break;
+            case 3:
+                a.emplace_head((int)x, tag);
+                b.emplace_front((int)x, tag);
+                break;
+            default:
+                if (pos < b.size()) {
+                    a.erase(a.begin() + pos);
+                    b.erase(jt);
+                }
+            }
+        }
+        check(a, b);
+        if (allocations > N / 100)
+            error();
+        while (!b.empty()) {
+            a.delete_tail();
+            b.pop_back();
+            if (!b.empty()) {
+                a.delete_head();
+                b.pop_front();
+            }
+        }
+        check(a, b);
+        long long before = allocations;
+        for (int i = 0; i < 1000; i++)
+            a.emplace_tail(i, "x");
+        if (allocations != before || alive != 1000)
+            error();
+    }
+    if (live_bytes != 0 || alive != 0)
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+void TestSplitMerge()
+{
+    std::cout << "Test 2 : Test for nodes moved to other lists...";
+    std::list<Item> b;
+    list* a = new list;
+    for (int i = 0; i < 1000; i++) {
+        a->emplace_tail(i, "s");
+        b.emplace_back(i, "s");
+    }
+    std::pair<list*, list*> halves = a->split(300);
+    delete a;
+    list c;
+    c.emplace_tail(-1, "c");
+    c.merge(halves.second);
+    c.merge(halves.first);
+    delete halves.second;
+    std::list<Item> d;
+    d.emplace_back(-1, "c");
+    d.insert(d.end(), std::next(b.begin(), 300), b.end());
+    d.insert(d.end(), b.begin(), std::next(b.begin(), 300));
+    check(c, d);
+    halves.first->emplace_tail(5, "f");
+    check(*halves.first, std::list<Item>(1, Item(5, "f")));
+    delete halves.first;
+    for (size_t pos : { (size_t)0, c.size(), c.size() / 2 }) {
+        std::pair<list*, list*> parts = c.split(pos);
+        if (parts.first->size() != std::min(pos, d.size()) || parts.first->size() + parts.second->size() != d.size())
+            error();
+        c.merge(parts.first);
+        c.merge(parts.second);
+        delete parts.first;
+        delete parts.second;
+        check(c, d);
+    }
+    while (!c.empty())
+        c.erase(c.begin());
+    if (alive != (long long)(b.size() + d.size()))
+        error();
+    b.clear();
+    d.clear();
+    if (alive != 0)
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+void TestCopyMove()
+{
+    std::cout << "Test 3 : Test for copies and moves between lists...";
+    {
+        list a(counting_allocator<Item>(1)), c(counting_allocator<Item>(2));
+        std::list<Item> b;
+        for (int i = 0; i < 500; i++) {
+            a.emplace_tail(i, "m");
+            b.emplace_back(i, "m");
+        }
+        list copy(a);
+        check(copy, b);
+        list moved(std::move(copy));
+        if (!copy.empty() || moved.get_allocator().id != 1)
+            error();
+        check(moved, b);
+        c = moved;
+        check(c, b);
+        c = std::move(moved);
+        if (c.get_allocator().id != 2 || !moved.empty())
+            error();
+        check(c, b);
+        list d(counting_allocator<Item>(1));
+        d.emplace_tail(-1, "d");
+        d = std::move(a);
+        check(d, b);
+        if (!a.empty())
+            error();
+        a.emplace_tail(7, "a");
+        swap(a, d);
+        check(a, b);
+        check(d, std::list<Item>(1, Item(7, "a")));
+        a = a;
+        check(a, b);
+    }
+    if (live_bytes != 0 || alive != 0)
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+#ifdef __cpp_lib_memory_resource
+/**
+ * a memory resource counting the bytes it hands out
+ */
+class counting_resource : public std::pmr::memory_resource {
+public:
+    long long bytes = 0;
+
+private:
+    void* do_allocate(size_t n, size_t align) override
+    {
+        bytes += n;
+        return std::pmr::new_delete_resource()->allocate(n, align);
+    }
+    void do_deallocate(void* p, size_t n, size_t align) override
+    {
+        bytes -= n;
+        std::pmr::new_delete_resource()->deallocate(p, n, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+#endif
+
+void TestResource()
+{
+    std::cout << "Test 4 : Test for the containers on a memory resource...";
+#ifdef __cpp_lib_memory_resource
+    counting_resource res;
+    {
+        sjtu::pmr::double_list<std::string> a(&res);
+        sjtu::pmr::deque<std::string> c(&res);
+        for (int i = 0; i < 1000; i++) {
+            a.insert_tail(std::to_string(i));
+            c.push_back(std::to_string(i));
+        }
+        if (res.bytes == 0)
+            error();
+        auto it = a.cbegin();
+        for (int i = 0; i < 1000; i++, it++) {
+            if (*it != std::to_string(i) || c[i] != *it)
+                error();
+        }
+        sjtu::pmr::double_list<std::string> d(std::move(a));
+        if (!a.empty() || d.size() != 1000 || *d.clast() != "999")
+            error();
+    }
+    if (res.bytes != 0)
+        error();
+#endif
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    TestPool();
+    TestSplitMerge();
+    TestCopyMove();
+    TestResource();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
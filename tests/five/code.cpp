@@ -0,0 +1,145 @@
+/***********************************************************************
+Test for persistent_deque: every version is checked against a std::deque
+holding the same elements, after the newer versions have been derived.
+***********************************************************************/
+#include "class-integer.hpp"
+#include "persistent_deque.hpp"
+#include <deque>
+#include <iostream>
+#include <vector>
+
+long long randNum(long long x, long long maxNum)
+{
+    x = (x * 10007) % maxNum;
+    return x + 1;
+}
+const int N = 10005;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+template <class A, class B>
+void check(const A& a, const B& b)
+{
+    if (a.size() != b.size())
+        error();
+    auto it = a.cbegin();
+    for (size_t i = 0; i < b.size(); i++, it++) {
+        auto x = *it, y = a[i];
+        if (!(x == b[i]) || !(y == b[i]))
+            error();
+    }
+    if (it != a.cend())
+        error();
+}
+
+void TestPush()
+{
+    std::cout << "Test 1 : Test for push_back() and push_front()...";
+    std::vector<sjtu::persistent_deque<Integer>> versions(1);
+    std::vector<std::deque<Integer>> answers(1);
+    for (int i = 0; i < N; i++) {
+        Integer x(randNum(i, N + 17));
+        versions.push_back(i % 3 ? versions.back().push_back(x) : versions.back().push_front(x));
+        answers.push_back(answers.back());
+        if (i % 3)
+            answers.back().push_back(x);
+        else
+            answers.back().push_front(x);
+    }
+    for (int i = 0; i <= N; i += 97)
+        check(versions[i], answers[i]);
+    std::cout << "Correct." << std::endl;
+}
+void TestInsertErase()
+{
+    std::cout << "Test 2 : Test for random insert, erase and set...";
+    sjtu::persistent_deque<Integer> cur;
+    std::deque<Integer> ans;
+    std::vector<sjtu::persistent_deque<Integer>> versions;
+    std::vector<std::deque<Integer>> answers;
+    for (int i = 0; i < N; i++) {
+        Integer x(randNum(i, N + 17));
+        size_t pos = randNum(i + 1, ans.size() + 1) - 1;
+        if (i % 5 == 4 && !ans.empty()) {
+            pos %= ans.size();
+            cur = cur.erase(cur.cbegin() + pos);
+            ans.erase(ans.begin() + pos);
+        } else if (i % 5 == 3 && !ans.empty()) {
+            pos %= ans.size();
+            cur = cur.set(pos, x);
+            ans[pos] = x;
+        } else {
+            cur = cur.insert(cur.cbegin() + pos, x);
+            ans.insert(ans.begin() + pos, x);
+        }
+        if (i % 101 == 0) {
+            versions.push_back(cur);
+            answers.push_back(ans);
+        }
+    }
+    for (size_t i = 0; i < versions.size(); i++)
+        check(versions[i], answers[i]);
+    std::cout << "Correct." << std::endl;
+}
+void TestPop()
+{
+    std::cout << "Test 3 : Test for pop_back() and pop_front()...";
+    sjtu::persistent_deque<Integer> full;
+    for (int i = 0; i < N; i++)
+        full = full.push_back(Integer(i));
+    sjtu::persistent_deque<Integer> cur = full;
+    for (int i = 0; i < N / 2; i++)
+        cur = i % 2 ? cur.pop_back() : cur.pop_front();
+    if (full.size() != (size_t)N || cur.size() != (size_t)(N - N / 2))
+        error();
+    Integer ff = full.front(), fb = full.back(), cf = cur.front(), cb = cur.back();
+    if (!(ff == Integer(0)) || !(fb == Integer(N - 1)))
+        error();
+    if (!(cf == Integer((N / 2 + 1) / 2)) || !(cb == Integer(N - 1 - N / 2 / 2)))
+        error();
+    std::cout << "Correct." << std::endl;
+}
+void TestException()
+{
+    std::cout << "Test 4 : Test for exceptions...";
+    sjtu::persistent_deque<Integer> a, b;
+    a = a.push_back(Integer(1));
+    int cnt = 0;
+    try {
+        b.pop_back();
+    } catch (sjtu::container_is_empty&) {
+        cnt++;
+    }
+    try {
+        a.at(1);
+    } catch (sjtu::index_out_of_bound&) {
+        cnt++;
+    }
+    try {
+        a.insert(b.cbegin(), Integer(2));
+    } catch (sjtu::invalid_iterator&) {
+        cnt++;
+    }
+    try {
+        a.erase(a.cend());
+    } catch (sjtu::invalid_iterator&) {
+        cnt++;
+    }
+    if (cnt != 4 || a.size() != 1 || !b.empty())
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    TestPush();
+    TestInsertErase();
+    TestPop();
+    TestException();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
@@ -0,0 +1,219 @@
+/***********************************************************************
+Test for the iterators as random access iterators: the iterator traits
+(and the concepts under C++20), std::sort, std::lower_bound and
+std::reverse on iterator ranges, reverse and const iterators, and the
+arithmetic and comparisons across blocks, all checked against a
+std::deque.
+***********************************************************************/
+#include "deque.hpp"
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <type_traits>
+#if __cplusplus >= 202002L
+#include <concepts>
+#endif
+
+typedef sjtu::deque_policy<> plain;
+typedef sjtu::deque_policy<3, false, sjtu::rebalance_policy::amortized, 2, true, sjtu::block_directory::tree> small_cow;
+
+long long randNum(long long x, long long maxNum)
+{
+    x = (x * 10007) % maxNum;
+    return x + 1;
+}
+const int N = 10005;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+template <class D>
+void check(const D& a, const std::deque<int>& b)
+{
+    if (a.size() != b.size())
+        error();
+    size_t i = 0;
+    for (auto it = a.cbegin(); it != a.cend(); ++it, ++i) {
+        if (*it != b[i])
+            error();
+    }
+}
+
+template <class It>
+void checkTraits()
+{
+    static_assert(std::is_same<typename std::iterator_traits<It>::iterator_category, std::random_access_iterator_tag>::value, "not random access");
+    static_assert(std::is_same<typename std::iterator_traits<It>::difference_type, std::ptrdiff_t>::value, "wrong difference_type");
+#if __cplusplus >= 202002L
+    static_assert(std::random_access_iterator<It>, "not a random_access_iterator");
+#endif
+}
+
+template <class P>
+void TestTraits()
+{
+    std::cout << "Test 1 : Test for the iterator traits...";
+    typedef sjtu::deque<int, P> D;
+    checkTraits<typename D::iterator>();
+    checkTraits<typename D::const_iterator>();
+    checkTraits<typename D::reverse_iterator>();
+    checkTraits<typename D::const_reverse_iterator>();
+    static_assert(std::is_same<typename std::iterator_traits<typename D::iterator>::reference, int&>::value, "wrong reference");
+    static_assert(std::is_same<typename std::iterator_traits<typename D::const_iterator>::reference, const int&>::value, "wrong reference");
+    static_assert(std::is_convertible<typename D::iterator, typename D::const_iterator>::value, "no conversion to const_iterator");
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestAlgorithms()
+{
+    std::cout << "Test 2 : Test for std::sort, std::lower_bound and std::reverse...";
+    sjtu::deque<int, P> a;
+    std::deque<int> b;
+    for (int i = 0; i < N; i++) {
+        int x = (int)randNum(i, N);
+        if (x % 2) {
+            a.push_back(x);
+            b.push_back(x);
+        } else {
+            a.push_front(x);
+            b.push_front(x);
+        }
+    }
+    std::sort(a.begin() + 100, a.end() - 100);
+    std::sort(b.begin() + 100, b.end() - 100);
+    check(a, b);
+    std::sort(a.begin(), a.end(), [](int x, int y) { return x > y; });
+    std::sort(b.begin(), b.end(), [](int x, int y) { return x > y; });
+    check(a, b);
+    std::reverse(a.begin(), a.end());
+    std::reverse(b.begin(), b.end());
+    check(a, b);
+    const sjtu::deque<int, P>& c = a;
+    for (int i = 0; i < 1000; i++) {
+        int x = (int)randNum(i, N + 2) - 1;
+        auto it = std::lower_bound(c.begin(), c.end(), x);
+        auto jt = std::upper_bound(a.begin(), a.end(), x);
+        auto bt = std::lower_bound(b.begin(), b.end(), x);
+        if (it - c.begin() != bt - b.begin() || (it != c.end() && *it != *bt))
+            error();
+        if (jt - a.begin() != std::upper_bound(b.begin(), b.end(), x) - b.begin())
+            error();
+        if (std::binary_search(c.cbegin(), c.cend(), x) != std::binary_search(b.begin(), b.end(), x))
+            error();
+    }
+    if (std::is_sorted(a.rbegin(), a.rend()) || !std::is_sorted(a.rbegin(), a.rend(), std::greater<int>()))
+        error();
+    std::sort(a.rbegin(), a.rend());
+    std::sort(b.rbegin(), b.rend());
+    check(a, b);
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestReverse()
+{
+    std::cout << "Test 3 : Test for reverse and const iterators...";
+    sjtu::deque<int, P> a;
+    std::deque<int> b;
+    for (int i = 0; i < 1000; i++) {
+        a.push_back(i);
+        b.push_back(i);
+    }
+    const sjtu::deque<int, P>& c = a;
+    if (a.rend() - a.rbegin() != 1000 || c.rend() - c.rbegin() != 1000 || a.crend() - a.crbegin() != 1000)
+        error();
+    auto bt = b.rbegin();
+    for (auto it = c.rbegin(); it != c.rend(); ++it, ++bt) {
+        if (*it != *bt)
+            error();
+    }
+    for (int i = 0; i < 1000; i += 7) {
+        *(a.rbegin() + i) = -*(a.rbegin() + i);
+        *(b.rbegin() + i) = -*(b.rbegin() + i);
+    }
+    check(a, b);
+    for (int i = 0; i < 1000; i += 3) {
+        if (a.rbegin()[i] != b.rbegin()[i] || *(c.crend() - 1 - i) != b[i] || (a.rbegin() + i).base() != a.end() - i)
+            error();
+    }
+    std::deque<int> d(a.crbegin() + 10, a.crend() - 10);
+    if (d != std::deque<int>(b.rbegin() + 10, b.rend() - 10))
+        error();
+    typename sjtu::deque<int, P>::const_iterator ci = a.begin() + 5;
+    if (ci != c.begin() + 5 || *ci != b[5] || ci - c.begin() != 5)
+        error();
+    int thrown = 0;
+    try {
+        (void)a.end().operator->();
+    } catch (sjtu::invalid_iterator&) {
+        thrown++;
+    }
+    try {
+        (void)c.cend().operator->();
+    } catch (sjtu::invalid_iterator&) {
+        thrown++;
+    }
+    if (thrown != 2)
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestArithmetic()
+{
+    std::cout << "Test 4 : Test for arithmetic and comparisons across blocks...";
+    sjtu::deque<int, P> a;
+    std::deque<int> b;
+    for (int i = 0; i < 2000; i++) {
+        a.push_front(i);
+        b.push_front(i);
+    }
+    auto first = a.begin();
+    auto cfirst = a.cbegin();
+    for (int i = 0; i < 2000; i++) {
+        long long j = randNum(i, 2000) - 1;
+        auto it = first + i, jt = j + first;
+        if (*it != b[i] || first[j] != b[j] || cfirst[i] != b[i] || *jt != b[j])
+            error();
+        if (jt - it != j - i || it - jt != i - j)
+            error();
+        if ((it < jt) != (i < j) || (it > jt) != (i > j) || (it <= jt) != (i <= j) || (it >= jt) != (i >= j) || (it == jt) != (i == j))
+            error();
+        auto kt = it;
+        kt += j - i;
+        if (kt != jt)
+            error();
+        kt -= j - i;
+        if (kt != it || it[j - i] != b[j] || *(jt - (j - i)) != b[i])
+            error();
+    }
+    if (a.end() - a.begin() != 2000 || a.begin() + 2000 != a.end() || a.end() - 2000 != a.begin())
+        error();
+    auto it = a.end();
+    for (int i = 1999; i >= 0; i--) {
+        if (*--it != b[i])
+            error();
+    }
+    if (it != a.begin())
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    TestTraits<plain>();
+    TestAlgorithms<plain>();
+    TestReverse<plain>();
+    TestArithmetic<plain>();
+    TestTraits<small_cow>();
+    TestAlgorithms<small_cow>();
+    TestReverse<small_cow>();
+    TestArithmetic<small_cow>();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
@@ -0,0 +1,157 @@
+/***********************************************************************
+Test for the tree directory: small blocks make the B+ tree several levels
+deep, so insertions and erasures split and merge its nodes while locating
+and random access are checked against a std::deque, also when allocating
+a node or a block fails in the middle of an insertion, which must then
+leave the deque as it was.
+***********************************************************************/
+#include "deque.hpp"
+#include <deque>
+#include <iostream>
+#include <new>
+
+typedef sjtu::deque_policy<2, false, sjtu::rebalance_policy::never, 2, false, sjtu::block_directory::tree> tiny;
+typedef sjtu::deque_policy<5, false, sjtu::rebalance_policy::amortized, 2, false, sjtu::block_directory::tree> small;
+
+long long randNum(long long x, long long maxNum)
+{
+    x = (x * 10007) % maxNum;
+    return x + 1;
+}
+const int N = 40005;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+long long budget = -1;
+
+template <class T>
+struct limited_allocator {
+    typedef T value_type;
+    limited_allocator() = default;
+    template <class U>
+    limited_allocator(const limited_allocator<U>&) { }
+    T* allocate(size_t n)
+    {
+        if (budget == 0)
+            throw std::bad_alloc();
+        if (budget > 0)
+            budget--;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n)
+    {
+        std::allocator<T>().deallocate(p, n);
+        return;
+    }
+    bool operator==(const limited_allocator&) const { return true; }
+    bool operator!=(const limited_allocator&) const { return false; }
+};
+
+template <class D>
+void check(const D& a, const std::deque<int>& b)
+{
+    if (a.size() != b.size())
+        error();
+    for (size_t i = 0; i < b.size(); i++) {
+        if (a[i] != b[i])
+            error();
+    }
+    size_t i = 0;
+    for (auto it = a.cbegin(); it != a.cend(); ++it, ++i) {
+        if (*it != b[i] || it - a.cbegin() != (long long)i)
+            error();
+    }
+}
+
+template <class P>
+void TestSplitMerge()
+{
+    std::cout << "Test 1 : Test for insertions and erasures across node splits and merges...";
+    sjtu::deque<int, P> a;
+    std::deque<int> b;
+    for (int i = 0; i < N; i++) {
+        long long x = randNum(i, N);
+        size_t pos = x % (b.size() + 1);
+        a.insert(a.begin() + pos, (int)x);
+        b.insert(b.begin() + pos, (int)x);
+        if (i % 4000 == 0)
+            check(a, b);
+    }
+    check(a, b);
+    for (int i = 0; i < N - 100; i++) {
+        long long x = randNum(i + N, N);
+        size_t pos = x % b.size();
+        if (a.at(pos) != b[pos])
+            error();
+        a.erase(a.begin() + pos);
+        b.erase(b.begin() + pos);
+        if (i % 4000 == 0)
+            check(a, b);
+    }
+    check(a, b);
+    for (int i = 0; i < N; i++) {
+        long long x = randNum(i, N);
+        if (x % 3 == 0) {
+            a.push_front((int)x);
+            b.push_front((int)x);
+        } else if (x % 3 == 1 && !b.empty()) {
+            a.pop_back();
+            b.pop_back();
+        } else {
+            a.push_back((int)x);
+            b.push_back((int)x);
+        }
+    }
+    check(a, b);
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestFailedInsert()
+{
+    std::cout << "Test 2 : Test for insertions that run out of memory...";
+    sjtu::deque<int, P, limited_allocator<int>> a;
+    std::deque<int> b;
+    int failed = 0;
+    for (int i = 0; i < N / 4; i++) {
+        long long x = randNum(i, N);
+        size_t pos = x % (b.size() + 1);
+        for (long long k = 0;; k++) {
+            budget = k;
+            try {
+                a.insert(a.begin() + pos, (int)x);
+                b.insert(b.begin() + pos, (int)x);
+                break;
+            } catch (std::bad_alloc&) {
+                failed++;
+                if (a.size() != b.size() || (!b.empty() && a[pos % b.size()] != b[pos % b.size()]))
+                    error();
+            }
+        }
+        budget = -1;
+        if (i % 500 == 0)
+            check(a, b);
+    }
+    check(a, b);
+    if (failed == 0)
+        error();
+    while (!b.empty()) {
+        a.erase(a.begin() + b.size() / 2);
+        b.erase(b.begin() + b.size() / 2);
+    }
+    check(a, b);
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    TestSplitMerge<tiny>();
+    TestFailedInsert<tiny>();
+    TestSplitMerge<small>();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
@@ -0,0 +1,237 @@
+/***********************************************************************
+Test for emplace, emplace_back, emplace_front and the rvalue insert,
+push_back and push_front: a move-only element is built in place or moved
+in, and a copyable element counting its copies must never be copied, all
+checked against a std::deque.
+***********************************************************************/
+#include "deque.hpp"
+#include <deque>
+#include <iostream>
+#include <string>
+
+typedef sjtu::deque_policy<> plain;
+typedef sjtu::deque_policy<5, false, sjtu::rebalance_policy::incremental, 2, false, sjtu::block_directory::tree> small;
+typedef sjtu::deque_policy<0, true, sjtu::rebalance_policy::threshold> threshold;
+
+long long randNum(long long x, long long maxNum)
+{
+    x = (x * 10007) % maxNum;
+    return x + 1;
+}
+const int N = 10005;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+/**
+ * an element that can only be moved, built from two arguments
+ */
+class Token {
+public:
+    int num;
+    std::string tag;
+    Token(int num, std::string tag)
+        : num(num)
+        , tag(std::move(tag))
+    {
+    }
+    Token(const Token&) = delete;
+    Token& operator=(const Token&) = delete;
+    Token(Token&& other) noexcept
+        : num(other.num)
+        , tag(std::move(other.tag))
+    {
+        other.num = -1;
+    }
+    Token& operator=(Token&& other) noexcept
+    {
+        num = other.num;
+        tag = std::move(other.tag);
+        other.num = -1;
+        return *this;
+    }
+    bool operator==(const Token& rhs) const
+    {
+        return num == rhs.num && tag == rhs.tag;
+    }
+};
+
+long long copies = 0, moves = 0;
+
+/**
+ * a copyable element counting its copies and moves
+ */
+struct Counted {
+    int num;
+    Counted(int num)
+        : num(num)
+    {
+    }
+    Counted(const Counted& other)
+        : num(other.num)
+    {
+        copies++;
+    }
+    Counted(Counted&& other) noexcept
+        : num(other.num)
+    {
+        moves++;
+    }
+    Counted& operator=(const Counted& other)
+    {
+        num = other.num;
+        copies++;
+        return *this;
+    }
+    Counted& operator=(Counted&& other) noexcept
+    {
+        num = other.num;
+        moves++;
+        return *this;
+    }
+};
+
+template <class D>
+void check(const D& a, const std::deque<Token>& b)
+{
+    if (a.size() != b.size())
+        error();
+    size_t i = 0;
+    for (auto it = a.cbegin(); it != a.cend(); ++it, ++i) {
+        if (!(*it == b[i]))
+            error();
+    }
+}
+
+template <class P>
+void TestMoveOnly()
+{
+    std::cout << "Test 1 : Test for a move-only element...";
+    sjtu::deque<Token, P> a;
+    std::deque<Token> b;
+    for (int i = 0; i < N; i++) {
+        long long x = randNum(i, N);
+        std::string tag = std::to_string(x % 97);
+        size_t pos = x % (b.size() + 1);
+        switch (x % 7) {
+        case 0: {
+            auto it = a.emplace(a.begin() + pos, (int)x, tag);
+            b.emplace(b.begin() + pos, (int)x, tag);
+            if (it - a.begin() != (long long)pos || it->num != (int)x)
+                error();
+            break;
+        }
+        case 1: {
+            Token t((int)x, tag);
+            auto it = a.insert(a.begin() + pos, std::move(t));
+            b.insert(b.begin() + pos, Token((int)x, tag));
+            if (t.num != -1 || it->num != (int)x)
+                error();
+            break;
+        }
+        case 2: {
+            Token& t = a.emplace_back((int)x, tag);
+            b.emplace_back((int)x, tag);
+            if (&t != &a.back() || t.tag != tag)
+                error();
+            break;
+        }
+        case 3: {
+            Token& t = a.emplace_front((int)x, tag);
+            b.emplace_front((int)x, tag);
+            if (&t != &a.front() || t.num != (int)x)
+                error();
+            break;
+        }
+        case 4:
+            a.push_back(Token((int)x, tag));
+            b.push_back(Token((int)x, tag));
+            break;
+        case 5:
+            a.push_front(Token((int)x, tag));
+            b.push_front(Token((int)x, tag));
+            break;
+        default:
+            if (pos < b.size()) {
+                a.erase(a.begin() + pos);
+                b.erase(b.begin() + pos);
+            }
+        }
+        if (i % 1000 == 0)
+            check(a, b);
+    }
+    check(a, b);
+    sjtu::deque<Token, P> c(std::move(a));
+    check(c, b);
+    Token t(0, "");
+    if (!c.try_pop_back(t) || !(t == b.back()) || !c.try_pop_front(t) || !(t == b.front()))
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestNoCopies()
+{
+    std::cout << "Test 2 : Test for elements that must not be copied...";
+    sjtu::deque<Counted, P> a;
+    std::deque<int> b;
+    copies = moves = 0;
+    for (int i = 0; i < N; i++) {
+        long long x = randNum(i, N);
+        size_t pos = x % (b.size() + 1);
+        switch (x % 6) {
+        case 0:
+            a.emplace(a.begin() + pos, (int)x);
+            b.insert(b.begin() + pos, (int)x);
+            break;
+        case 1:
+            a.insert(a.begin() + pos, Counted((int)x));
+            b.insert(b.begin() + pos, (int)x);
+            break;
+        case 2:
+            a.emplace_back((int)x);
+            b.push_back((int)x);
+            break;
+        case 3:
+            a.emplace_front((int)x);
+            b.push_front((int)x);
+            break;
+        case 4:
+            a.push_back(Counted((int)x));
+            b.push_back((int)x);
+            break;
+        default:
+            if (pos < b.size()) {
+                a.erase(a.begin() + pos);
+                b.erase(b.begin() + pos);
+            }
+        }
+    }
+    if (copies != 0 || moves == 0)
+        error();
+    for (size_t i = 0; i < b.size(); i++) {
+        if (a[i].num != b[i])
+            error();
+    }
+    Counted c(1);
+    a.push_back(c);
+    a.insert(a.begin(), c);
+    if (copies != 2)
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    TestMoveOnly<plain>();
+    TestNoCopies<plain>();
+    TestMoveOnly<small>();
+    TestNoCopies<small>();
+    TestMoveOnly<threshold>();
+    TestNoCopies<threshold>();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
@@ -0,0 +1,143 @@
+/***********************************************************************
+Test for concurrent_deque: the operations of one thread are checked
+against a std::deque, then producers and consumers run at both ends at
+once and every element must come out exactly once.
+***********************************************************************/
+#include "class-integer.hpp"
+#include "concurrent_deque.hpp"
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+long long randNum(long long x, long long maxNum)
+{
+    x = (x * 10007) % maxNum;
+    return x + 1;
+}
+const int N = 100005;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+void TestSequential()
+{
+    std::cout << "Test 1 : Test for push, pop, insert, erase and at in one thread...";
+    sjtu::concurrent_deque<Integer> a;
+    std::deque<Integer> b;
+    for (int i = 0; i < N; i++) {
+        long long x = randNum(i, N), op = x % 6;
+        Integer out(0);
+        if (op == 0) {
+            a.push_back(Integer((int)x));
+            b.push_back(Integer((int)x));
+        } else if (op == 1) {
+            a.push_front(Integer((int)x));
+            b.push_front(Integer((int)x));
+        } else if (op == 2) {
+            if (a.try_pop_front(out) != !b.empty() || (!b.empty() && !(out == b.front())))
+                error();
+            if (!b.empty())
+                b.pop_front();
+        } else if (op == 3) {
+            if (a.try_pop_back(out) != !b.empty() || (!b.empty() && !(out == b.back())))
+                error();
+            if (!b.empty())
+                b.pop_back();
+        } else if (op == 4 && i % 17 == 0) {
+            size_t pos = x % (b.size() + 1);
+            a.insert(pos, Integer((int)x));
+            b.insert(b.begin() + pos, Integer((int)x));
+        } else if (op == 5 && i % 17 == 0 && !b.empty()) {
+            size_t pos = x % b.size();
+            a.erase(pos);
+            b.erase(b.begin() + pos);
+        } else {
+            for (int k = 0; k < 3; k++) {
+                a.push_back(Integer((int)x + k));
+                b.push_back(Integer((int)x + k));
+            }
+        }
+        if (a.size() != b.size())
+            error();
+    }
+    for (size_t i = 0; i < b.size(); i++) {
+        if (!(a.at(i) == b[i]))
+            error();
+    }
+    try {
+        a.at(b.size());
+        error();
+    } catch (...) {
+    }
+    a.clear();
+    Integer out(0);
+    if (!a.empty() || a.try_pop_front(out) || a.try_pop_back(out))
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+void TestThreads()
+{
+    std::cout << "Test 2 : Test for producers and consumers at both ends...";
+    sjtu::concurrent_deque<long long> a;
+    const int P = 4, C = 4, K = 50000;
+    std::vector<std::thread> threads;
+    std::vector<long long> sum(C, 0), cnt(C, 0);
+    for (int p = 0; p < P; p++) {
+        threads.emplace_back([&a, p] {
+            for (long long i = 1; i <= K; i++) {
+                if (p % 2)
+                    a.push_back(i);
+                else
+                    a.push_front(i);
+            }
+            a.push_back(-1);
+        });
+    }
+    for (int c = 0; c < C; c++) {
+        threads.emplace_back([&, c] {
+            long long x;
+            while (true) {
+                if (c % 2)
+                    a.wait_pop_back(x);
+                else
+                    a.wait_pop_front(x);
+                if (x < 0)
+                    break;
+                sum[c] += x;
+                cnt[c]++;
+            }
+        });
+    }
+    for (std::thread& t : threads)
+        t.join();
+    long long total = 0, n = 0, x;
+    for (int c = 0; c < C; c++) {
+        total += sum[c];
+        n += cnt[c];
+    }
+    while (a.try_pop_front(x)) {
+        if (x < 0)
+            continue;
+        total += x;
+        n++;
+    }
+    if (n != (long long)P * K || total != (long long)P * K * (K + 1) / 2)
+        error();
+    if (a.wait_pop_front(x, std::chrono::milliseconds(10)))
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    TestSequential();
+    TestThreads();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
@@ -0,0 +1,151 @@
+/***********************************************************************
+Test for set_block_bytes: the block lengths follow the byte sizes set at
+runtime for deques created afterwards, deques created before keep
+working, elements are moved between deques of different block lengths,
+a fixed block capacity ignores the setting, and 0 restores the default.
+***********************************************************************/
+#include "deque.hpp"
+#include <deque>
+#include <iostream>
+
+typedef sjtu::deque<int> D;
+typedef sjtu::deque<int, sjtu::deque_policy<0, true, sjtu::rebalance_policy::never>> fixed_length;
+typedef sjtu::deque<int, sjtu::deque_policy<8>> fixed_capacity;
+
+struct Wide {
+    char buf[100];
+};
+
+long long randNum(long long x, long long maxNum)
+{
+    x = (x * 10007) % maxNum;
+    return x + 1;
+}
+const int N = 20005;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+template <class Q>
+void check(const Q& a, const std::deque<int>& b)
+{
+    if (a.size() != b.size())
+        error();
+    size_t i = 0;
+    for (auto it = a.cbegin(); it != a.cend(); ++it, ++i) {
+        if (*it != b[i])
+            error();
+    }
+}
+
+/**
+ * the longest contiguous run of a
+ */
+template <class Q>
+size_t longest(const Q& a)
+{
+    size_t res = 0;
+    for (size_t i = 0; i < a.size();) {
+        auto seg = a.segment(i);
+        res = std::max(res, (size_t)(seg.second - seg.first));
+        i += seg.second - seg.first;
+    }
+    return res;
+}
+
+template <class Q>
+void fill(Q& a, std::deque<int>& b, int n)
+{
+    for (int i = 0; i < n; i++) {
+        long long x = randNum(i, N);
+        size_t pos = x % (b.size() + 1);
+        if (x % 3 == 0) {
+            a.insert(a.begin() + pos, (int)x);
+            b.insert(b.begin() + pos, (int)x);
+        } else if (x % 3 == 1) {
+            a.push_back((int)x);
+            b.push_back((int)x);
+        } else {
+            a.push_front((int)x);
+            b.push_front((int)x);
+        }
+    }
+}
+
+void TestLengths()
+{
+    std::cout << "Test 1 : Test for the block lengths after set_block_bytes...";
+    size_t min0 = D::min_length(), max0 = D::max_length();
+    if (min0 != std::max(sjtu::cache_size(1) / 8 / sizeof(int), (size_t)16) || max0 < min0)
+        error();
+    sjtu::set_block_bytes(64 * sizeof(int), 1024 * sizeof(int));
+    if (D::min_length() != 64 || D::max_length() != 1024 || sjtu::deque<Wide>::min_length() != 16 || sjtu::deque<Wide>::max_length() != 40)
+        error();
+    if (fixed_capacity::min_length() != 8 || fixed_capacity::max_length() != 8)
+        error();
+    fixed_length a;
+    std::deque<int> b;
+    if (a.block_length() != 64)
+        error();
+    fill(a, b, N);
+    check(a, b);
+    if (a.block_length() != 64 || longest(a) > 64)
+        error();
+    D c;
+    std::deque<int> d;
+    fill(c, d, N);
+    check(c, d);
+    if (c.block_length() < 64 || c.block_length() > 1024 || longest(c) > c.block_length())
+        error();
+    sjtu::set_block_bytes(0);
+    if (D::min_length() != min0 || D::max_length() != max0)
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+void TestBeforeAfter()
+{
+    std::cout << "Test 2 : Test for deques created before and after a change...";
+    sjtu::set_block_bytes(16 * sizeof(int), 64 * sizeof(int));
+    fixed_length a;
+    std::deque<int> b;
+    fill(a, b, N / 2);
+    fixed_capacity e;
+    std::deque<int> f;
+    fill(e, f, N / 4);
+    sjtu::set_block_bytes(256 * sizeof(int), 512 * sizeof(int));
+    fixed_length c;
+    std::deque<int> d;
+    fill(c, d, N / 2);
+    if (a.block_length() != 16 || c.block_length() != 256 || e.block_length() != 8 || longest(a) > 16 || longest(c) > 256 || longest(e) > 8)
+        error();
+    fill(a, b, N / 2);
+    check(a, b);
+    c.splice_back(std::move(a));
+    d.insert(d.end(), b.begin(), b.end());
+    check(c, d);
+    fixed_length g = c.split_at(c.size() / 3);
+    std::deque<int> h(d.begin() + d.size() / 3, d.end());
+    d.erase(d.begin() + d.size() / 3, d.end());
+    g.splice_front(std::move(c));
+    h.insert(h.begin(), d.begin(), d.end());
+    fill(g, h, N / 4);
+    check(g, h);
+    fixed_length k(g);
+    check(k, h);
+    fill(e, f, N / 4);
+    check(e, f);
+    sjtu::set_block_bytes(0);
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    TestLengths();
+    TestBeforeAfter();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
@@ -0,0 +1,259 @@
+/***********************************************************************
+Test for algorithm.hpp: the segmented and the parallel algorithms are
+checked against the standard ones run over a std::deque holding the same
+elements.
+***********************************************************************/
+#include "algorithm.hpp"
+#include "deque.hpp"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+long long randNum(long long x, long long maxNum)
+{
+    x = (x * 10007) % maxNum;
+    return x + 1;
+}
+const int N = 100005;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+template <class D>
+void fill(D& a, std::deque<long long>& b)
+{
+    for (int i = 0; i < N; i++) {
+        long long x = randNum(i, 1007);
+        if (i % 3) {
+            a.push_back(x);
+            b.push_back(x);
+        } else {
+            a.push_front(x);
+            b.push_front(x);
+        }
+        if (i % 101 == 0) {
+            a.insert(a.begin() + b.size() / 2, x);
+            b.insert(b.begin() + b.size() / 2, x);
+        }
+    }
+}
+
+template <class D>
+void TestSegments()
+{
+    std::cout << "Test 1 : Test for segment() and for_each_segment()...";
+    D a;
+    std::deque<long long> b;
+    fill(a, b);
+    size_t total = 0;
+    sjtu::for_each_segment(a, [&](long long* first, long long* last) {
+        for (; first != last; ++first, ++total) {
+            if (*first != b[total])
+                error();
+            *first += 1;
+        }
+    });
+    if (total != b.size())
+        error();
+    for (size_t i = 0; i < b.size(); i += 7) {
+        if (a[i] != b[i] + 1)
+            error();
+    }
+    size_t part = 0, from = b.size() / 3, to = b.size() / 3 * 2;
+    const D& c = a;
+    sjtu::for_each_segment(c, from, to, [&](const long long* first, const long long* last) {
+        for (; first != last; ++first, ++part) {
+            if (*first != b[from + part] + 1)
+                error();
+        }
+    });
+    if (part != to - from)
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+template <class D>
+void TestAlgorithms()
+{
+    std::cout << "Test 2 : Test for for_each(), find(), count(), accumulate() and copy()...";
+    D a;
+    std::deque<long long> b;
+    fill(a, b);
+    sjtu::for_each(a, [](long long& x) { x *= 3; });
+    std::for_each(b.begin(), b.end(), [](long long& x) { x *= 3; });
+    const D& c = a;
+    for (long long v = 0; v < 3100; v += 31) {
+        if (sjtu::count(c, v) != (size_t)std::count(b.begin(), b.end(), v))
+            error();
+        if ((size_t)(sjtu::find(a, v) - a.begin()) != (size_t)(std::find(b.begin(), b.end(), v) - b.begin()))
+            error();
+        if ((size_t)(sjtu::find_if(c, [v](long long x) { return x > v; }) - c.cbegin()) != (size_t)(std::find_if(b.begin(), b.end(), [v](long long x) { return x > v; }) - b.begin()))
+            error();
+    }
+    if (sjtu::accumulate(c, 0LL) != std::accumulate(b.begin(), b.end(), 0LL))
+        error();
+    if (sjtu::accumulate(c, 0LL, [](long long s, long long x) { return s ^ (x * 7); }) != std::accumulate(b.begin(), b.end(), 0LL, [](long long s, long long x) { return s ^ (x * 7); }))
+        error();
+    std::vector<long long> out(b.size());
+    if (sjtu::copy(c, out.data()) != out.data() + out.size() || !std::equal(out.begin(), out.end(), b.begin()))
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+template <class D>
+void TestParallel()
+{
+    std::cout << "Test 3 : Test for the parallel algorithms...";
+    D a;
+    std::deque<long long> b;
+    fill(a, b);
+    sjtu::thread_pool pool(4);
+    sjtu::parallel_for_each(a, [](long long& x) { x = x * 5 + 2; }, pool);
+    std::for_each(b.begin(), b.end(), [](long long& x) { x = x * 5 + 2; });
+    sjtu::deque<long long> c;
+    sjtu::parallel_transform(a, c, [](long long x) { return x % 11; }, pool);
+    for (size_t i = 0; i < b.size(); i++) {
+        if (a[i] != b[i] || c[i] != b[i] % 11)
+            error();
+    }
+    auto add = [](long long s, long long x) { return s + x; };
+    long long sum = std::accumulate(b.begin(), b.end(), 3LL);
+    if (sjtu::parallel_reduce(a, 3LL, add, true, pool) != sum || sjtu::parallel_reduce(a, 3LL, add, false, pool) != sum)
+        error();
+    auto last = [](long long, long long x) { return x; };
+    if (sjtu::parallel_reduce(a, 3LL, last, true, pool) != b.back() || sjtu::parallel_reduce(a, 3LL, last, false, pool) != b.back())
+        error();
+    if (sjtu::parallel_count_if(c, [](long long x) { return x == 4; }, pool) != (size_t)std::count(c.begin(), c.end(), 4))
+        error();
+    for (long long v = 0; v < 5100; v += 51) {
+        if ((size_t)(sjtu::parallel_find_if(a, [v](long long x) { return x == v; }, pool) - a.begin()) != (size_t)(std::find(b.begin(), b.end(), v) - b.begin()))
+            error();
+    }
+    std::cout << "Correct." << std::endl;
+}
+
+template <class D>
+void TestSort()
+{
+    std::cout << "Test 4 : Test for sort() and stable_sort()...";
+    D a;
+    std::deque<long long> b;
+    fill(a, b);
+    sjtu::thread_pool pool(4);
+    D c(a);
+    auto tens = [](long long x, long long y) { return x / 10 < y / 10; };
+    sjtu::stable_sort(a, tens, pool);
+    std::stable_sort(b.begin(), b.end(), tens);
+    for (size_t i = 0; i < b.size(); i++) {
+        if (a[i] != b[i])
+            error();
+    }
+    sjtu::sort(c);
+    std::sort(b.begin(), b.end());
+    for (size_t i = 0; i < b.size(); i++) {
+        if (c[i] != b[i])
+            error();
+    }
+    D e;
+    sjtu::sort(e);
+    e.push_back(2);
+    e.push_back(1);
+    sjtu::stable_sort(e);
+    if (e.size() != 2 || e[0] != 1 || e[1] != 2)
+        error();
+    for (size_t n : { (size_t)100, b.size() }) {
+        sjtu::deque<std::unique_ptr<long long>> m;
+        for (size_t i = 0; i < n; i++)
+            m.push_back(std::unique_ptr<long long>(new long long(randNum(i, 1007))));
+        auto less = [](const std::unique_ptr<long long>& x, const std::unique_ptr<long long>& y) { return *x < *y; };
+        sjtu::sort(m, less, pool);
+        for (size_t i = 1; i < n; i++) {
+            if (*m[i - 1] > *m[i])
+                error();
+        }
+        sjtu::stable_sort(m, [](const std::unique_ptr<long long>& x, const std::unique_ptr<long long>& y) { return *x % 7 < *y % 7; }, pool);
+        for (size_t i = 1; i < n; i++) {
+            if (*m[i - 1] % 7 > *m[i] % 7 || (*m[i - 1] % 7 == *m[i] % 7 && *m[i - 1] > *m[i]))
+                error();
+        }
+    }
+    std::cout << "Correct." << std::endl;
+}
+
+template <class D>
+void TestKernels()
+{
+    std::cout << "Test 5 : Test for min_element(), max_element() and the vectorized kernels...";
+    D a;
+    std::deque<long long> b;
+    fill(a, b);
+    a[b.size() / 3] = b[b.size() / 3] = -5;
+    a[b.size() / 2] = b[b.size() / 2] = 5000;
+    if ((size_t)(sjtu::min_element(a) - a.begin()) != (size_t)(std::min_element(b.begin(), b.end()) - b.begin()))
+        error();
+    if ((size_t)(sjtu::max_element(a) - a.begin()) != (size_t)(std::max_element(b.begin(), b.end()) - b.begin()))
+        error();
+    auto odd = [](long long x, long long y) { return x % 7 < y % 7; };
+    if ((size_t)(sjtu::max_element(a, odd) - a.begin()) != (size_t)(std::max_element(b.begin(), b.end(), odd) - b.begin()))
+        error();
+    sjtu::deque<int> c;
+    std::deque<int> e;
+    sjtu::deque<double> f;
+    std::deque<double> h;
+    for (size_t i = 0; i < b.size(); i++) {
+        c.push_back((int)(b[i] % 101));
+        e.push_back((int)(b[i] % 101));
+        f.push_front(b[i] / 8.0);
+        h.push_front(b[i] / 8.0);
+    }
+    for (int v = -3; v < 110; v += 7) {
+        if (sjtu::count(c, v) != (size_t)std::count(e.begin(), e.end(), v) || sjtu::count(f, v / 8.0) != (size_t)std::count(h.begin(), h.end(), v / 8.0))
+            error();
+        if ((size_t)(sjtu::find(c, v) - c.begin()) != (size_t)(std::find(e.begin(), e.end(), v) - e.begin()))
+            error();
+        if ((size_t)(sjtu::find(f, v / 8.0) - f.begin()) != (size_t)(std::find(h.begin(), h.end(), v / 8.0) - h.begin()))
+            error();
+    }
+    if (sjtu::accumulate(c, 7) != std::accumulate(e.begin(), e.end(), 7) || sjtu::accumulate(a, 7LL) != std::accumulate(b.begin(), b.end(), 7LL))
+        error();
+    if ((size_t)(sjtu::min_element(f) - f.begin()) != (size_t)(std::min_element(h.begin(), h.end()) - h.begin()))
+        error();
+    f[h.size() / 2] = h[h.size() / 2] = std::nan("");
+    if ((size_t)(sjtu::max_element(f) - f.begin()) != (size_t)(std::max_element(h.begin(), h.end()) - h.begin()))
+        error();
+    sjtu::deque<double, sjtu::deque_policy<4>> g;
+    std::deque<double> k;
+    double small[] = { 3, 5, 7, 8, std::nan(""), 1, 2 };
+    for (double x : small) {
+        g.push_back(x);
+        k.push_back(x);
+    }
+    if ((size_t)(sjtu::min_element(g) - g.begin()) != (size_t)(std::min_element(k.begin(), k.end()) - k.begin()))
+        error();
+    if ((size_t)(sjtu::max_element(g) - g.begin()) != (size_t)(std::max_element(k.begin(), k.end()) - k.begin()))
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    TestSegments<sjtu::deque<long long>>();
+    TestAlgorithms<sjtu::deque<long long>>();
+    TestParallel<sjtu::deque<long long>>();
+    TestSort<sjtu::deque<long long>>();
+    TestKernels<sjtu::deque<long long>>();
+    TestSegments<sjtu::deque<long long, sjtu::deque_policy<7, false, sjtu::rebalance_policy::amortized, 2, true, sjtu::block_directory::tree>>>();
+    TestAlgorithms<sjtu::deque<long long, sjtu::deque_policy<7, false, sjtu::rebalance_policy::amortized, 2, true, sjtu::block_directory::tree>>>();
+    TestParallel<sjtu::deque<long long, sjtu::deque_policy<7, false, sjtu::rebalance_policy::amortized, 2, true, sjtu::block_directory::tree>>>();
+    TestSort<sjtu::deque<long long, sjtu::deque_policy<7, false, sjtu::rebalance_policy::amortized, 2, true, sjtu::block_directory::tree>>>();
+    TestKernels<sjtu::deque<long long, sjtu::deque_policy<7, false, sjtu::rebalance_policy::amortized, 2, true, sjtu::block_directory::tree>>>();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
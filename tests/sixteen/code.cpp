@@ -0,0 +1,188 @@
+/***********************************************************************
+Test for the rebalance policies: every policy, and a deque switched to
+another policy halfway, is checked against a std::deque under mixed
+insertions and erasures, with small blocks so that the length follows
+sqrt(n). Under threshold the block length must stay within factor times
+sqrt(n), and every rebuild must leave full blocks of a length between
+min_length() and max_length(). Under incremental the sweep wraps around
+the blocks many times, and the iterators returned by insert and erase
+must survive the splits and merges of each step.
+***********************************************************************/
+#include "deque.hpp"
+#include <cmath>
+#include <deque>
+#include <iostream>
+
+typedef sjtu::deque<int> D;
+typedef sjtu::rebalance_policy policy;
+
+long long randNum(long long x, long long maxNum)
+{
+    x = (x * 10007) % maxNum;
+    return x + 1;
+}
+const int N = 30005;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+void check(const D& a, const std::deque<int>& b)
+{
+    if (a.size() != b.size())
+        error();
+    size_t i = 0;
+    for (auto it = a.cbegin(); it != a.cend(); ++it, ++i) {
+        if (*it != b[i])
+            error();
+    }
+}
+
+/**
+ * the number of contiguous runs of a, and the longest one
+ */
+std::pair<size_t, size_t> runs(const D& a)
+{
+    size_t cnt = 0, longest = 0;
+    for (size_t i = 0; i < a.size(); cnt++) {
+        std::pair<const int*, const int*> seg = a.segment(i);
+        longest = std::max(longest, (size_t)(seg.second - seg.first));
+        i += seg.second - seg.first;
+    }
+    return std::make_pair(cnt, longest);
+}
+
+/**
+ * the block length a rebuild aims at
+ */
+size_t target(const D& a)
+{
+    size_t res = std::sqrt(a.size()) + 1;
+    return std::min(std::max(res, D::min_length()), D::max_length());
+}
+
+/**
+ * after an insertion under threshold, the length must be near sqrt(n),
+ * and a rebuild, seen as a change of the length, leaves full blocks
+ * return whether there was a rebuild
+ */
+bool checkThreshold(const D& a, size_t length, size_t factor)
+{
+    if (a.get_rebalance_policy() != policy::threshold)
+        return false;
+    size_t t = target(a);
+    if (a.block_length() > t * factor || a.block_length() * factor < t)
+        error();
+    if (a.block_length() == length)
+        return false;
+    if (a.block_length() < D::min_length() || a.block_length() > D::max_length())
+        error();
+    std::pair<size_t, size_t> r = runs(a);
+    if (r.first != (a.size() + a.block_length() - 1) / a.block_length() || r.second != std::min(a.size(), a.block_length()))
+        error();
+    return true;
+}
+
+/**
+ * mixed operations on a under its policy, the deque grows for the first
+ * half of steps and shrinks for the second half
+ * return the number of rebuilds seen under threshold
+ */
+int run(D& a, std::deque<int>& b, int first, int last, size_t factor)
+{
+    int rebuilds = 0;
+    for (int i = first; i < last; i++) {
+        long long x = randNum(i, N);
+        bool grow = i % N < N / 2;
+        if (x % 4 == 0 || b.empty() || (grow && x % 4 == 1)) {
+            size_t pos = x % (b.size() + 1), length = a.block_length();
+            auto it = a.insert(a.begin() + pos, (int)x);
+            b.insert(b.begin() + pos, (int)x);
+            if (*it != (int)x || it - a.begin() != (long long)pos)
+                error();
+            rebuilds += checkThreshold(a, length, factor);
+        } else if (x % 4 == 1) {
+            size_t pos = x % b.size();
+            auto it = a.erase(a.begin() + pos);
+            b.erase(b.begin() + pos);
+            if (pos < b.size() && *it != b[pos])
+                error();
+        } else if (x % 4 == 2) {
+            size_t l = x % b.size(), r = std::min(b.size(), l + (size_t)(x % 50));
+            auto it = a.erase(a.begin() + l, a.begin() + r);
+            b.erase(b.begin() + l, b.begin() + r);
+            if (l < b.size() && *it != b[l])
+                error();
+            if (grow && r > l) {
+                size_t length = a.block_length();
+                a.insert(a.begin() + l, 2 * (r - l), (int)x);
+                b.insert(b.begin() + l, 2 * (r - l), (int)x);
+                rebuilds += checkThreshold(a, length, factor);
+            }
+        } else if (x % 8 == 3) {
+            a.push_back((int)x);
+            b.push_back((int)x);
+        } else {
+            a.pop_front();
+            b.pop_front();
+        }
+        if (i % 1000 == 0) {
+            check(a, b);
+            if (runs(a).second > D::max_length())
+                error();
+        }
+    }
+    check(a, b);
+    return rebuilds;
+}
+
+void TestPolicies()
+{
+    std::cout << "Test 1 : Test for each rebalance policy...";
+    policy all[] = { policy::never, policy::amortized, policy::threshold, policy::incremental };
+    for (policy p : all) {
+        for (size_t factor : { (size_t)2, (size_t)3 }) {
+            D a;
+            std::deque<int> b;
+            a.set_rebalance_policy(p, factor);
+            if (a.get_rebalance_policy() != p)
+                error();
+            int rebuilds = run(a, b, 0, N, factor);
+            if (p == policy::threshold && rebuilds == 0)
+                error();
+        }
+    }
+    std::cout << "Correct." << std::endl;
+}
+
+void TestSwitch()
+{
+    std::cout << "Test 2 : Test for switching the policy halfway...";
+    policy all[] = { policy::never, policy::amortized, policy::threshold, policy::incremental };
+    for (policy p : all) {
+        for (policy q : all) {
+            D a;
+            std::deque<int> b;
+            a.set_rebalance_policy(p);
+            run(a, b, 0, N / 4, 2);
+            a.set_rebalance_policy(q, 1);
+            if (a.get_rebalance_policy() != q)
+                error();
+            run(a, b, N / 4, N / 2 + N / 4, 2);
+        }
+    }
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    sjtu::set_block_bytes(16 * sizeof(int), 256 * sizeof(int));
+    if (D::min_length() != 16 || D::max_length() != 256)
+        error();
+    TestPolicies();
+    TestSwitch();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
@@ -0,0 +1,207 @@
+/***********************************************************************
+Test for splice_back, splice_front, split_at and split_front: empty
+operands, splicing a deque into itself, splitting at the ends and inside
+a block, and operands still sharing their blocks with a copy, all checked
+against a std::deque.
+***********************************************************************/
+#include "deque.hpp"
+#include <deque>
+#include <iostream>
+
+typedef sjtu::deque_policy<> plain;
+typedef sjtu::deque_policy<8, false, sjtu::rebalance_policy::amortized, 2, true, sjtu::block_directory::tree> small_cow;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+template <class D>
+void check(const D& a, const std::deque<int>& b)
+{
+    if (a.size() != b.size() || a.empty() != b.empty())
+        error();
+    size_t i = 0;
+    for (auto it = a.cbegin(); it != a.cend(); ++it, ++i) {
+        if (*it != b[i] || a[i] != b[i])
+            error();
+    }
+    if (i != b.size())
+        error();
+}
+
+template <class D>
+void fill(D& a, std::deque<int>& b, int first, int last)
+{
+    for (int i = first; i < last; i++) {
+        a.push_back(i);
+        b.push_back(i);
+    }
+}
+
+template <class P>
+void TestEmpty()
+{
+    std::cout << "Test 1 : Test for empty operands and splicing into itself...";
+    typedef sjtu::deque<int, P> D;
+    D a, e;
+    std::deque<int> b;
+    a.splice_back(std::move(e));
+    a.splice_front(std::move(e));
+    check(a, b);
+    fill(a, b, 0, 100);
+    a.splice_back(D());
+    a.splice_front(std::move(e));
+    check(a, b);
+    a.splice_back(std::move(a));
+    a.splice_front(std::move(a));
+    check(a, b);
+    D c;
+    c.splice_back(std::move(a));
+    check(c, b);
+    check(a, std::deque<int>());
+    a.splice_front(std::move(c));
+    check(a, b);
+    check(c, std::deque<int>());
+    D f = e.split_at(0), g = e.split_front(0);
+    check(e, std::deque<int>());
+    check(f, std::deque<int>());
+    check(g, std::deque<int>());
+    try {
+        e.split_at(1);
+        error();
+    } catch (sjtu::index_out_of_bound&) {
+    }
+    try {
+        a.split_front(101);
+        error();
+    } catch (sjtu::index_out_of_bound&) {
+    }
+    check(a, b);
+    a.push_back(100);
+    a.push_front(-1);
+    b.push_back(100);
+    b.push_front(-1);
+    check(a, b);
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestSplit()
+{
+    std::cout << "Test 2 : Test for splitting at the ends and inside a block...";
+    typedef sjtu::deque<int, P> D;
+    const int n = 1000;
+    for (int at = 0; at <= n; at += at < 20 ? 1 : 37) {
+        D a;
+        std::deque<int> b;
+        fill(a, b, 0, n);
+        if (at % 2 == 0) {
+            D c = a.split_at(at);
+            std::deque<int> d(b.begin() + at, b.end());
+            b.erase(b.begin() + at, b.end());
+            check(a, b);
+            check(c, d);
+            c.push_front(-1);
+            d.push_front(-1);
+            a.push_back(-2);
+            b.push_back(-2);
+            a.splice_back(std::move(c));
+            b.insert(b.end(), d.begin(), d.end());
+        } else {
+            D c = a.split_front(at);
+            std::deque<int> d(b.begin(), b.begin() + at);
+            b.erase(b.begin(), b.begin() + at);
+            check(a, b);
+            check(c, d);
+            c.push_back(-1);
+            d.push_back(-1);
+            a.push_front(-2);
+            b.push_front(-2);
+            a.splice_front(std::move(c));
+            b.insert(b.begin(), d.begin(), d.end());
+        }
+        check(a, b);
+        a.insert(a.begin() + a.size() / 2, -3);
+        b.insert(b.begin() + b.size() / 2, -3);
+        a.erase(a.begin() + a.size() / 3);
+        b.erase(b.begin() + b.size() / 3);
+        check(a, b);
+    }
+    D a;
+    std::deque<int> b;
+    fill(a, b, 0, n);
+    D c = a.split_at(n), d = a.split_front(0);
+    check(a, b);
+    check(c, std::deque<int>());
+    check(d, std::deque<int>());
+    c = a.split_at(0);
+    check(a, std::deque<int>());
+    check(c, b);
+    d = c.split_front(n);
+    check(c, std::deque<int>());
+    check(d, b);
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestShared()
+{
+    std::cout << "Test 3 : Test for operands sharing their blocks with a copy...";
+    typedef sjtu::deque<int, P> D;
+    D a, c;
+    std::deque<int> b, d;
+    fill(a, b, 0, 500);
+    fill(c, d, 500, 900);
+    D a0(a), c0(c);
+    a.splice_back(std::move(c));
+    b.insert(b.end(), d.begin(), d.end());
+    check(a, b);
+    check(c, std::deque<int>());
+    D e = a.split_at(333);
+    std::deque<int> f(b.begin() + 333, b.end());
+    b.erase(b.begin() + 333, b.end());
+    D g = e.split_front(111);
+    std::deque<int> h(f.begin(), f.begin() + 111);
+    f.erase(f.begin(), f.begin() + 111);
+    for (size_t i = 0; i < b.size(); i += 7) {
+        a[i] = -(int)i;
+        b[i] = -(int)i;
+    }
+    for (size_t i = 0; i < f.size(); i += 5) {
+        e[i] = -(int)i;
+        f[i] = -(int)i;
+    }
+    g.push_front(-1);
+    h.push_front(-1);
+    e.splice_front(std::move(g));
+    f.insert(f.begin(), h.begin(), h.end());
+    a.splice_back(D(a0));
+    std::deque<int> a1;
+    for (int i = 0; i < 500; i++)
+        a1.push_back(i);
+    b.insert(b.end(), a1.begin(), a1.end());
+    check(a, b);
+    check(e, f);
+    check(a0, a1);
+    std::deque<int> c1(d);
+    check(c0, c1);
+    c0.splice_front(std::move(a0));
+    c1.insert(c1.begin(), a1.begin(), a1.end());
+    check(c0, c1);
+    check(a0, std::deque<int>());
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    TestEmpty<plain>();
+    TestSplit<plain>();
+    TestShared<plain>();
+    TestEmpty<small_cow>();
+    TestSplit<small_cow>();
+    TestShared<small_cow>();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
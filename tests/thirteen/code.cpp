@@ -0,0 +1,165 @@
+/***********************************************************************
+Test for the non-throwing accessors try_at, try_front, try_back,
+try_pop_front and try_pop_back: a null pointer or false on an empty deque
+or an index out of bound, and the same elements as at, front and back
+otherwise, also when a write through them meets a copy sharing its block.
+***********************************************************************/
+#include "deque.hpp"
+#include <deque>
+#include <iostream>
+#include <string>
+
+typedef sjtu::deque_policy<> plain;
+typedef sjtu::deque_policy<5, false, sjtu::rebalance_policy::amortized, 2, true, sjtu::block_directory::tree> small_cow;
+
+long long randNum(long long x, long long maxNum)
+{
+    x = (x * 10007) % maxNum;
+    return x + 1;
+}
+const int N = 20005;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+template <class D>
+void check(const D& a, const std::deque<std::string>& b)
+{
+    if (a.size() != b.size())
+        error();
+    for (size_t i = 0; i < b.size(); i++) {
+        if (a.try_at(i) == nullptr || *a.try_at(i) != b[i])
+            error();
+    }
+    if (a.try_at(b.size()) != nullptr)
+        error();
+}
+
+template <class P>
+void TestEmpty()
+{
+    std::cout << "Test 1 : Test for an empty deque...";
+    sjtu::deque<std::string, P> a;
+    const sjtu::deque<std::string, P>& c = a;
+    std::string out = "unchanged";
+    if (a.try_at(0) != nullptr || a.try_front() != nullptr || a.try_back() != nullptr)
+        error();
+    if (c.try_at(0) != nullptr || c.try_front() != nullptr || c.try_back() != nullptr)
+        error();
+    if (a.try_pop_back() || a.try_pop_front() || a.try_pop_back(out) || a.try_pop_front(out))
+        error();
+    if (out != "unchanged" || !a.empty())
+        error();
+    a.push_back("x");
+    if (a.try_at(1) != nullptr || a.try_at((size_t)-1) != nullptr || c.try_at(1) != nullptr)
+        error();
+    if (a.try_front() != a.try_back() || *c.try_front() != "x" || a.try_front() != &a.front())
+        error();
+    if (!a.try_pop_front(out) || out != "x" || !a.empty() || a.try_pop_back(out))
+        error();
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestRandom()
+{
+    std::cout << "Test 2 : Test for the accessors against std::deque...";
+    sjtu::deque<std::string, P> a;
+    std::deque<std::string> b;
+    for (int i = 0; i < N; i++) {
+        long long x = randNum(i, N);
+        std::string s = std::to_string(x);
+        std::string out;
+        switch (x % 6) {
+        case 0:
+            a.push_back(s);
+            b.push_back(s);
+            break;
+        case 1:
+            a.push_front(s);
+            b.push_front(s);
+            break;
+        case 2:
+            if (a.try_pop_back(out) != !b.empty())
+                error();
+            if (!b.empty()) {
+                if (out != b.back())
+                    error();
+                b.pop_back();
+            }
+            break;
+        case 3:
+            if (a.try_pop_front() != !b.empty())
+                error();
+            if (!b.empty())
+                b.pop_front();
+            break;
+        case 4: {
+            size_t pos = x % (b.size() + 2);
+            std::string* p = a.try_at(pos);
+            if ((p == nullptr) != (pos >= b.size()))
+                error();
+            if (p != nullptr) {
+                if (*p != b[pos])
+                    error();
+                *p = s;
+                b[pos] = s;
+            }
+            break;
+        }
+        default:
+            if ((a.try_front() == nullptr) != b.empty() || (a.try_back() == nullptr) != b.empty())
+                error();
+            if (!b.empty() && (*a.try_front() != b.front() || *a.try_back() != b.back()))
+                error();
+            if (!b.empty() && (a.try_front() != &a.front() || a.try_back() != &a.back()))
+                error();
+            break;
+        }
+    }
+    check(a, b);
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestShared()
+{
+    std::cout << "Test 3 : Test for writes through the accessors on a copy...";
+    sjtu::deque<std::string, P> a;
+    std::deque<std::string> b;
+    for (int i = 0; i < 100; i++) {
+        a.push_back(std::to_string(i));
+        b.push_back(std::to_string(i));
+    }
+    sjtu::deque<std::string, P> c(a);
+    const sjtu::deque<std::string, P>& d = c;
+    if (*d.try_at(50) != "50" || *d.try_front() != "0" || *d.try_back() != "99")
+        error();
+    *a.try_at(50) = "a";
+    *a.try_front() = "b";
+    *a.try_back() = "c";
+    std::string out;
+    if (!c.try_pop_back(out) || out != "99" || !c.try_pop_front(out) || out != "0")
+        error();
+    check(c, std::deque<std::string>(b.begin() + 1, b.end() - 1));
+    b[50] = "a";
+    b.front() = "b";
+    b.back() = "c";
+    check(a, b);
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    TestEmpty<plain>();
+    TestRandom<plain>();
+    TestShared<plain>();
+    TestEmpty<small_cow>();
+    TestRandom<small_cow>();
+    TestShared<small_cow>();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
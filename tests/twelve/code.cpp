@@ -0,0 +1,184 @@
+/***********************************************************************
+Test for SJTU_ITERATOR_CHECKS 2: every insertion or erasure starts a new
+generation, and an iterator made before it throws invalid_iterator when
+it is used, while the iterators returned by the modification and those
+made after it still work. With SJTU_ITERATOR_CHECKS 0 the same checks
+are compiled out and such a use is undefined behaviour.
+***********************************************************************/
+#define SJTU_ITERATOR_CHECKS 2
+#include "deque.hpp"
+#include <deque>
+#include <iostream>
+
+typedef sjtu::deque_policy<> plain;
+typedef sjtu::deque_policy<4, false, sjtu::rebalance_policy::amortized, 2, true, sjtu::block_directory::tree> small_cow;
+
+void error()
+{
+    std::cout << "Error, mismatch found." << std::endl;
+    exit(0);
+}
+
+template <class D>
+void check(const D& a, const std::deque<int>& b)
+{
+    if (a.size() != b.size())
+        error();
+    size_t i = 0;
+    for (auto it = a.cbegin(); it != a.cend(); ++it, ++i) {
+        if (*it != b[i])
+            error();
+    }
+}
+
+template <class It>
+void expectStale(It it)
+{
+    int thrown = 0;
+    try {
+        (void)*it;
+    } catch (sjtu::invalid_iterator&) {
+        thrown++;
+    }
+    try {
+        ++it;
+    } catch (sjtu::invalid_iterator&) {
+        thrown++;
+    }
+    try {
+        --it;
+    } catch (sjtu::invalid_iterator&) {
+        thrown++;
+    }
+    try {
+        (void)(it + 1);
+    } catch (sjtu::invalid_iterator&) {
+        thrown++;
+    }
+    try {
+        (void)(it - 1);
+    } catch (sjtu::invalid_iterator&) {
+        thrown++;
+    }
+    if (thrown != 5)
+        error();
+}
+
+template <class D>
+void expectStaleModify(D& a, typename D::iterator it)
+{
+    int thrown = 0;
+    try {
+        a.insert(it, 1);
+    } catch (sjtu::invalid_iterator&) {
+        thrown++;
+    }
+    try {
+        a.erase(it);
+    } catch (sjtu::invalid_iterator&) {
+        thrown++;
+    }
+    try {
+        a.erase(it, a.end());
+    } catch (sjtu::invalid_iterator&) {
+        thrown++;
+    }
+    if (thrown != 3)
+        error();
+}
+
+template <class P>
+void TestInvalidated()
+{
+    std::cout << "Test 1 : Test for iterators used after an insertion or an erasure...";
+    typedef sjtu::deque<int, P> D;
+    if (sjtu::iterator_checks != 2)
+        error();
+    D a;
+    std::deque<int> b;
+    for (int i = 0; i < 100; i++) {
+        a.push_back(i);
+        b.push_back(i);
+    }
+    auto it = a.begin() + 50;
+    auto cit = a.cbegin() + 20;
+    a.insert(a.begin() + 10, -1);
+    b.insert(b.begin() + 10, -1);
+    expectStale(it);
+    expectStale(cit);
+    expectStaleModify(a, it);
+    check(a, b);
+    it = a.begin() + 50;
+    cit = a.cbegin() + 20;
+    a.erase(a.begin() + 70);
+    b.erase(b.begin() + 70);
+    expectStale(it);
+    expectStale(cit);
+    expectStaleModify(a, it);
+    check(a, b);
+    it = a.end();
+    a.push_back(100);
+    b.push_back(100);
+    expectStaleModify(a, it);
+    it = a.begin();
+    a.pop_front();
+    b.pop_front();
+    expectStale(it);
+    it = a.begin() + 5;
+    a.erase(a.begin() + 30, a.begin() + 40);
+    b.erase(b.begin() + 30, b.begin() + 40);
+    expectStale(it);
+    expectStaleModify(a, it);
+    it = a.begin() + 5;
+    a.clear();
+    b.clear();
+    expectStale(it);
+    check(a, b);
+    std::cout << "Correct." << std::endl;
+}
+
+template <class P>
+void TestStillValid()
+{
+    std::cout << "Test 2 : Test for iterators made or returned after a modification...";
+    typedef sjtu::deque<int, P> D;
+    D a;
+    std::deque<int> b;
+    for (int i = 0; i < 100; i++) {
+        a.push_front(i);
+        b.push_front(i);
+    }
+    auto it = a.begin() + 40;
+    const D& c = a;
+    if (*it != b[40] || c[3] != b[3] || c.at(7) != b[7] || *(c.cbegin() + 9) != b[9] || *it != b[40])
+        error();
+    for (int i = 0; i < 50; i++) {
+        it = a.insert(it, i);
+        b.insert(b.begin() + 40, i);
+        if (*it != i)
+            error();
+    }
+    check(a, b);
+    for (int i = 0; i < 30; i++) {
+        it = a.erase(it);
+        b.erase(b.begin() + 40);
+        if (*it != b[40])
+            error();
+    }
+    it = a.erase(it, it + 10);
+    b.erase(b.begin() + 40, b.begin() + 50);
+    if (*it != b[40] || *(it - 40) != b[0])
+        error();
+    check(a, b);
+    std::cout << "Correct." << std::endl;
+}
+
+int main()
+{
+    TestInvalidated<plain>();
+    TestStillValid<plain>();
+    TestInvalidated<small_cow>();
+    TestStillValid<small_cow>();
+    std::cout << "Congratulations. Your submission has passed all correctness tests." << std::endl;
+    return 0;
+}
@@ -0,0 +1,171 @@
+#ifndef SJTU_THREAD_POOL_HPP
+#define SJTU_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sjtu {
+/**
+ * a fixed set of worker threads, reused by the parallel algorithms
+ * run(n, f) calls f(0) ... f(n - 1) on the workers and the calling
+ * thread, which take the indices one by one, and returns when all of
+ * them are done. a pool runs one batch at a time, and a batch started
+ * from inside a task runs on the calling thread alone.
+ */
+class thread_pool {
+private:
+    /**
+     * a batch of tasks, on the stack of the thread running it
+     */
+    struct Batch {
+        void (*call)(void*, size_t);
+        void* ctx;
+        size_t n;
+        std::atomic<size_t> next;
+        std::exception_ptr error;
+        std::mutex error_lock;
+    };
+    std::vector<std::thread> workers;
+    std::mutex lock, run_lock;
+    std::condition_variable wake, done;
+    Batch* batch;
+    size_t users, serial;
+    bool stop;
+
+    /**
+     * the pool running a batch on the current thread, as a worker
+     * or as the caller
+     */
+    static thread_pool*& current()
+    {
+        static thread_local thread_pool* res = nullptr;
+        return res;
+    }
+    /**
+     * take and run tasks of b until there are no more
+     * the first exception is kept, the other tasks still run
+     */
+    static void execute(Batch& b)
+    {
+        for (size_t i = b.next++; i < b.n; i = b.next++) {
+            try {
+                b.call(b.ctx, i);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(b.error_lock);
+                if (!b.error)
+                    b.error = std::current_exception();
+            }
+        }
+        return;
+    }
+    void work()
+    {
+        current() = this;
+        size_t seen = 0;
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            wake.wait(guard, [&] { return stop || (batch != nullptr && serial != seen); });
+            if (stop)
+                return;
+            seen = serial;
+            Batch* b = batch;
+            users++;
+            guard.unlock();
+            execute(*b);
+            guard.lock();
+            if (--users == 0)
+                done.notify_all();
+        }
+    }
+
+public:
+    /**
+     * a pool running batches on threads threads, the caller included
+     * 0 takes the number of hardware threads
+     */
+    explicit thread_pool(size_t threads = 0)
+        : batch(nullptr)
+        , users(0)
+        , serial(0)
+        , stop(false)
+    {
+        if (threads == 0)
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+        for (size_t i = 1; i < threads; i++)
+            workers.emplace_back([this] { work(); });
+    }
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stop = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers)
+            t.join();
+    }
+
+    /**
+     * the pool shared by the parallel algorithms by default, created
+     * on first use with a thread per hardware thread
+     */
+    static thread_pool& instance()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+    /**
+     * the number of threads running a batch, the caller included
+     */
+    size_t size() const
+    {
+        return workers.size() + 1;
+    }
+
+    /**
+     * call f(i) for every i in [0, n), and rethrow the first exception
+     * thrown by a task once all of them are done
+     */
+    template <class F>
+    void run(size_t n, F f)
+    {
+        Batch b;
+        b.call = [](void* ctx, size_t i) { (*static_cast<F*>(ctx))(i); };
+        b.ctx = &f;
+        b.n = n;
+        b.next = 0;
+        thread_pool* outer = current();
+        current() = this;
+        if (n <= 1 || workers.empty() || outer == this) {
+            execute(b);
+        } else {
+            std::lock_guard<std::mutex> serialize(run_lock);
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                batch = &b;
+                serial++;
+            }
+            wake.notify_all();
+            execute(b);
+            std::unique_lock<std::mutex> guard(lock);
+            batch = nullptr;
+            done.wait(guard, [&] { return users == 0; });
+        }
+        current() = outer;
+        if (b.error)
+            std::rethrow_exception(b.error);
+        return;
+    }
+};
+}
+
+#endif